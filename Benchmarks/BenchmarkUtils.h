@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    BenchmarkUtils.h
+    Timing helpers shared by the benchmarks and the stress harness in Tools.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// average time of one call to 'function' over 'iterations' back to back calls
+template<typename Function>
+static double secondsPerCall(int iterations, Function&& function)
+{
+    auto start = juce::Time::getHighResolutionTicks();
+
+    for (int i = 0; i < iterations; ++i)
+        function();
+
+    auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+    return seconds / iterations;
+}
+
+template<typename Function>
+static double nanosecondsPerCall(int iterations, Function&& function)
+{
+    return secondsPerCall(iterations, std::forward<Function>(function)) * 1.0e9;
+}
+
+template<typename Function>
+static double microsecondsPerCall(int iterations, Function&& function)
+{
+    return secondsPerCall(iterations, std::forward<Function>(function)) * 1.0e6;
+}
+
+// a set of timings sorted once, to read the mean, percentiles and max off
+template<typename Value>
+struct Distribution
+{
+    explicit Distribution(std::vector<Value> valuesToSort) : values(std::move(valuesToSort))
+    {
+        std::sort(values.begin(), values.end());
+    }
+
+    bool isEmpty() const { return values.empty(); }
+
+    double getMean() const
+    {
+        double sum = 0.0;
+        for (auto value : values)
+            sum += double(value);
+        return values.empty() ? 0.0 : sum / double(values.size());
+    }
+
+    // the value 'fraction' of the way up, 0.99 for the p99
+    double getPercentile(double fraction) const
+    {
+        if (values.empty())
+            return 0.0;
+
+        return double(values[juce::jmin(values.size() - 1, size_t(double(values.size()) * fraction))]);
+    }
+
+    double getMax() const { return values.empty() ? 0.0 : double(values.back()); }
+
+    std::vector<Value> values;
+};
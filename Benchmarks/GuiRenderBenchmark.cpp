@@ -0,0 +1,193 @@
+/*
+  ==============================================================================
+
+    GuiRenderBenchmark.cpp
+    Builds the whole editor offscreen, no window and no display needed, and
+    renders it frame after frame into an Image at several sizes and display
+    scales. A processor fed with a synthetic sweep over noise keeps the
+    analyzer busy. Reports mean and p99 paint time per kind of component,
+    plus how long the editor took to construct and to get its first paint.
+
+    usage: GuiRenderBenchmark [frames]
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "PluginEditor.h"
+#include "BenchmarkUtils.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+
+// a sine sweeping 20Hz..20kHz every few seconds over low level noise
+struct SyntheticSignal
+{
+    void fill(juce::AudioBuffer<float>& buffer, double sampleRate)
+    {
+        for (int n = 0; n < buffer.getNumSamples(); ++n)
+        {
+            auto sweepPosition = std::fmod(time / 4.0, 1.0);
+            auto frequency = juce::mapToLog10(sweepPosition, 20.0, 20000.0);
+            phase += juce::MathConstants<double>::twoPi * frequency / sampleRate;
+            time += 1.0 / sampleRate;
+
+            auto sample = 0.25f * (float)std::sin(phase) + 0.02f * (random.nextFloat() * 2.f - 1.f);
+
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                buffer.setSample(ch, n, sample);
+        }
+    }
+
+    juce::Random random { 1234 };
+    double phase = 0.0, time = 0.0;
+};
+
+static const char* describe(juce::Component& component)
+{
+    if (dynamic_cast<ResponseCurveComponent*>(&component) != nullptr)  return "ResponseCurveComponent";
+    if (dynamic_cast<RotarySliderWithLabels*>(&component) != nullptr)  return "RotarySliderWithLabels";
+    if (dynamic_cast<PowerButton*>(&component) != nullptr)             return "PowerButton";
+    if (dynamic_cast<AnalyzerButton*>(&component) != nullptr)          return "AnalyzerButton";
+    if (dynamic_cast<juce::ComboBox*>(&component) != nullptr)          return "ComboBox";
+   #if EQ_ENABLE_PROFILING
+    if (dynamic_cast<CpuLoadMeter*>(&component) != nullptr)            return "CpuLoadMeter";
+   #endif
+    return "other";
+}
+
+static void printStats(const char* sizeText, float scale, const char* scenario, const std::string& name, std::vector<double> frameMs)
+{
+    Distribution<double> stats (std::move(frameMs));
+    if (stats.isEmpty())
+        return;
+
+    std::printf("%-10s %-6.2g %-11s %-24s %10.3f %10.3f\n", sizeText, scale, scenario, name.c_str(),
+                stats.getMean(), stats.getPercentile(0.99));
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const int frames = argc > 1 ? juce::jmax(2, std::atoi(argv[1])) : 300;
+    const double sampleRate = 48000.0;
+    const int blockSize = 512;
+
+    std::printf("%-10s %-6s %-11s %-24s %10s %10s\n", "size", "scale", "scenario", "component", "mean ms", "p99 ms");
+
+    for (auto size : { juce::Point<int> { 650, 650 }, juce::Point<int> { 1000, 800 }, juce::Point<int> { 1600, 1200 } })
+    {
+        for (auto scale : { 1.f, 1.5f, 2.f })
+        {
+            for (auto automating : { false, true })
+            {
+                EQPluginAudioProcessor processor;
+                processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+                processor.prepareToPlay(sampleRate, blockSize);
+
+                std::unique_ptr<juce::AudioProcessorEditor> editor (processor.createEditor());
+                editor->setSize(size.x, size.y);
+
+                ResponseCurveComponent* responseCurve = nullptr;
+                for (auto* child : editor->getChildren())
+                    if (auto* rcc = dynamic_cast<ResponseCurveComponent*>(child))
+                        responseCurve = rcc;
+
+                // there's no message loop to deliver the background build, so the analyzers are attached by hand
+                // right after the first paint, which is about where they'd turn up in a host
+                bool analyzerStarted = false;
+
+                SyntheticSignal signal;
+                juce::AudioBuffer<float> block (2, blockSize);
+                juce::MidiBuffer midi;
+                auto* peakFreq = processor.apvts.getParameter("Peak Freq");
+
+                juce::Image frame (juce::Image::RGB, juce::roundToInt(size.x * scale), juce::roundToInt(size.y * scale), true);
+
+                // per kind of component, summed over every instance, one entry per frame
+                std::map<std::string, std::vector<double>> timings;
+
+                auto timeMs = [](auto&& function)
+                {
+                    auto start = juce::Time::getHighResolutionTicks();
+                    function();
+                    return 1000.0 * juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+                };
+
+                for (int i = 0; i < frames; ++i)
+                {
+                    // one 60Hz display frame worth of audio
+                    for (int s = 0; s < int(sampleRate / 60.0); s += blockSize)
+                    {
+                        signal.fill(block, sampleRate);
+                        processor.processBlock(block, midi);
+                    }
+
+                    // automation drags the peak around, which moves a slider and the response curve every frame
+                    if (automating)
+                        peakFreq->setValueNotifyingHost(0.5f + 0.4f * std::sin(float(i) * 0.05f));
+
+                    if (responseCurve != nullptr && analyzerStarted)
+                        responseCurve->updateFrame();
+
+                    std::map<std::string, double> frameTimes;
+                    double totalMs = 0.0;
+
+                    {
+                        juce::Graphics g (frame);
+                        g.addTransform(juce::AffineTransform::scale(scale));
+                        totalMs += frameTimes["editor chrome"] = timeMs([&] { editor->paint(g); });
+                    }
+
+                    for (auto* child : editor->getChildren())
+                    {
+                        if (! child->isVisible())
+                            continue;
+
+                        juce::Graphics g (frame);
+                        g.addTransform(juce::AffineTransform::scale(scale));
+                        g.setOrigin(child->getPosition());
+                        g.reduceClipRegion(child->getLocalBounds());
+
+                        auto ms = timeMs([&] { child->paintEntireComponent(g, false); });
+                        frameTimes[describe(*child)] += ms;
+                        totalMs += ms;
+                    }
+
+                    frameTimes["total"] = totalMs;
+
+                    // the first frame fills every cache, leave it out of steady state
+                    if (i > 0)
+                        for (auto& [name, ms] : frameTimes)
+                            timings[name].push_back(ms);
+
+                    if (! analyzerStarted && responseCurve != nullptr)
+                    {
+                        responseCurve->startAnalyzerNow();
+                        analyzerStarted = true;
+                    }
+                }
+
+                // one sample each, so mean and p99 are the same number
+                if (auto* eqEditor = dynamic_cast<EQPluginAudioProcessorEditor*>(editor.get()))
+                {
+                    auto startup = eqEditor->getStartupTimings();
+                    timings["startup: constructed"] = { startup.constructed };
+                    timings["startup: first paint"] = { startup.firstPaint };
+                    timings["startup: analyzer ready"] = { startup.analyzerReady };
+                }
+
+                auto sizeText = juce::String(size.x) + "x" + juce::String(size.y);
+                for (auto& [name, frameMs] : timings)
+                    printStats(sizeText.toRawUTF8(), scale, automating ? "automating" : "steady", name, frameMs);
+
+                editor = nullptr;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+    ProcessBlockBenchmark.cpp
+    Runs EQPluginAudioProcessor::processBlock headlessly, no editor, over
+    every combination of sample rate, block size, mono or stereo layout and
+    a few slope and bypass settings, and times each block. Prints one JSON
+    object with ns per sample, times realtime and the p50/p99/max block time
+    of every case, so two runs can be diffed or checked against a budget.
+
+    usage: ProcessBlockBenchmark [seconds of audio per case] [output.json]
+
+    Without an output file the JSON goes to stdout, progress always goes to
+    stderr. Build in Release.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "BenchmarkUtils.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+    struct Setting
+    {
+        const char* parameter;
+        float value;
+    };
+
+    struct Configuration
+    {
+        const char* name;
+        std::vector<Setting> settings;
+        bool automated;     // peak frequency moves every block, like a host drawing an automation curve
+    };
+
+    struct BlockStats
+    {
+        double nsPerSample = 0.0, realtime = 0.0, p50Us = 0.0, p99Us = 0.0, maxUs = 0.0;
+    };
+
+    void setParameter(EQPluginAudioProcessor& processor, const char* parameterID, float value)
+    {
+        auto* parameter = processor.apvts.getParameter(parameterID);
+        jassert(parameter != nullptr);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    BlockStats summarise(std::vector<double> blockNs, juce::int64 totalSamples, double sampleRate)
+    {
+        BlockStats stats;
+        Distribution<double> blocks (std::move(blockNs));
+        if (blocks.isEmpty() || totalSamples == 0)
+            return stats;
+
+        const auto totalNs = blocks.getMean() * double(blocks.values.size());
+
+        stats.nsPerSample = totalNs / double(totalSamples);
+        stats.realtime = (double(totalSamples) / sampleRate) / (totalNs * 1.0e-9);
+        stats.p50Us = blocks.getPercentile(0.5) * 1.0e-3;
+        stats.p99Us = blocks.getPercentile(0.99) * 1.0e-3;
+        stats.maxUs = blocks.getMax() * 1.0e-3;
+        return stats;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const double secondsPerCase = argc > 1 ? juce::jmax(0.01, std::atof(argv[1])) : 1.0;
+    const juce::String outputPath = argc > 2 ? juce::String(argv[2]) : juce::String();
+
+    // slopes are choice indices, Slope_12 is 0 and Slope_48 is 3
+    const Configuration configurations[] =
+    {
+        { "all bypassed",  { { "LowCut Bypassed", 1.f }, { "Peak Bypassed", 1.f }, { "HighCut Bypassed", 1.f } }, false },
+        { "12 dB/oct",     { { "LowCut Slope", 0.f }, { "HighCut Slope", 0.f }, { "Peak Gain", 6.f } }, false },
+        { "48 dB/oct",     { { "LowCut Slope", 3.f }, { "HighCut Slope", 3.f }, { "Peak Gain", 6.f } }, false },
+        { "48 dB/oct, automated", { { "LowCut Slope", 3.f }, { "HighCut Slope", 3.f }, { "Peak Gain", 6.f } }, true },
+    };
+
+    auto* results = new juce::DynamicObject();
+    juce::Array<juce::var> cases;
+
+    for (auto sampleRate : { 44100.0, 48000.0, 96000.0, 192000.0 })
+    {
+        for (auto blockSize : { 1, 16, 64, 256, 512, 1024, 4096 })
+        {
+            for (auto numChannels : { 1, 2 })
+            {
+                for (const auto& configuration : configurations)
+                {
+                    EQPluginAudioProcessor processor;
+
+                    const auto channelSet = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+                    juce::AudioProcessor::BusesLayout layout;
+                    layout.inputBuses.add(channelSet);
+                    layout.outputBuses.add(channelSet);
+
+                    if (! processor.setBusesLayout(layout))
+                    {
+                        std::fprintf(stderr, "%d channel layout not supported, skipped\n", numChannels);
+                        continue;
+                    }
+
+                    // the parameters go in before prepareToPlay so the filters come up already designed for them
+                    for (const auto& setting : configuration.settings)
+                        setParameter(processor, setting.parameter, setting.value);
+
+                    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+                    processor.prepareToPlay(sampleRate, blockSize);
+
+                    juce::AudioBuffer<float> buffer (numChannels, blockSize);
+                    juce::MidiBuffer midi;
+                    juce::Random random (blockSize);
+
+                    const auto numBlocks = juce::jmax(1, int(secondsPerCase * sampleRate / blockSize));
+                    const auto warmUpBlocks = juce::jmax(1, numBlocks / 10);
+
+                    std::vector<double> blockNs;
+                    blockNs.reserve((size_t)numBlocks);
+
+                    for (int i = -warmUpBlocks; i < numBlocks; ++i)
+                    {
+                        if (configuration.automated)
+                            setParameter(processor, "Peak Freq", 1000.f + 800.f * std::sin(float(i) * 0.01f));
+
+                        for (int ch = 0; ch < numChannels; ++ch)
+                            for (int n = 0; n < blockSize; ++n)
+                                buffer.setSample(ch, n, random.nextFloat() * 0.5f - 0.25f);
+
+                        auto start = juce::Time::getHighResolutionTicks();
+                        processor.processBlock(buffer, midi);
+                        auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+                        if (i >= 0)
+                            blockNs.push_back(seconds * 1.0e9);
+                    }
+
+                    auto stats = summarise(std::move(blockNs), juce::int64(numBlocks) * blockSize, sampleRate);
+
+                    auto* result = new juce::DynamicObject();
+                    result->setProperty("sampleRate", sampleRate);
+                    result->setProperty("blockSize", blockSize);
+                    result->setProperty("channels", numChannels);
+                    result->setProperty("configuration", configuration.name);
+                    result->setProperty("nsPerSample", stats.nsPerSample);
+                    result->setProperty("realtime", stats.realtime);
+                    result->setProperty("p50Us", stats.p50Us);
+                    result->setProperty("p99Us", stats.p99Us);
+                    result->setProperty("maxUs", stats.maxUs);
+                    cases.add(juce::var(result));
+
+                    std::fprintf(stderr, "%6.0f Hz %5d samples %d ch %-22s %8.2f ns/sample %10.1fx realtime\n",
+                                 sampleRate, blockSize, numChannels, configuration.name, stats.nsPerSample, stats.realtime);
+                }
+            }
+        }
+    }
+
+    results->setProperty("benchmark", "processBlock");
+   #if JUCE_DEBUG
+    results->setProperty("build", "debug");
+   #else
+    results->setProperty("build", "release");
+   #endif
+    results->setProperty("secondsPerCase", secondsPerCase);
+    results->setProperty("cases", cases);
+
+    auto json = juce::JSON::toString(juce::var(results));
+
+    if (outputPath.isEmpty())
+    {
+        std::printf("%s\n", json.toRawUTF8());
+    }
+    else if (! juce::File::getCurrentWorkingDirectory().getChildFile(outputPath).replaceWithText(json))
+    {
+        std::fprintf(stderr, "can't write %s\n", outputPath.toRawUTF8());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    ResponseCurvePaintBenchmark.cpp
+    Paints a ResponseCurveComponent into an offscreen image frame after frame,
+    with and without its cached layers and with each spectrum renderer, while
+    noise runs through the processor so the analyzer always has a fresh
+    spectrum to draw.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "PluginEditor.h"
+#include "BenchmarkUtils.h"
+
+#include <cstdio>
+
+int main()
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const double sampleRate = 48000.0;
+    const int blockSize = 512;
+    const int frames = 600;
+
+    EQPluginAudioProcessor processor;
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    juce::AudioBuffer<float> block (2, blockSize);
+    juce::MidiBuffer midi;
+    juce::Random random (1234);
+
+    auto* peakGain = processor.apvts.getParameter("Peak Gain");
+
+    using Renderer = ResponseCurveComponent::SpectrumRenderer;
+
+    struct Setup
+    {
+        const char* name;
+        bool useLayerCache;
+        Renderer renderer;
+        bool fill;
+    };
+
+    const Setup setups[] =
+    {
+        { "direct, path",       false, Renderer::path,   false },
+        { "cached, path",       true,  Renderer::path,   false },
+        { "cached, bitmap",     true,  Renderer::bitmap, false },
+        { "cached, bitmap+fill", true, Renderer::bitmap, true },
+    };
+
+    std::printf("%-10s %-10s %-20s %12s %12s\n", "size", "scenario", "layers, spectrum", "mean ms", "p99 ms");
+
+    for (auto size : { juce::Point<int> { 600, 300 }, juce::Point<int> { 1200, 600 }, juce::Point<int> { 1920, 900 } })
+    {
+        for (auto dragging : { false, true })
+        {
+            for (const auto& setup : setups)
+            {
+                ResponseCurveComponent component (processor);
+                component.setBounds(0, 0, size.x, size.y);
+                component.setUsesLayerCache(setup.useLayerCache);
+                component.setSpectrumRenderer(setup.renderer);
+                component.setFillsSpectrum(setup.fill);
+                component.startAnalyzerNow(); // there's no message loop here to deliver the background build
+
+                juce::Image frame (juce::Image::RGB, size.x, size.y, true);
+                std::vector<double> frameMs;
+
+                for (int i = 0; i < frames; ++i)
+                {
+                    // one display frame worth of audio at 60 Hz
+                    for (int s = 0; s < int(sampleRate / 60.0); s += blockSize)
+                    {
+                        for (int ch = 0; ch < block.getNumChannels(); ++ch)
+                            for (int n = 0; n < blockSize; ++n)
+                                block.setSample(ch, n, random.nextFloat() * 0.5f - 0.25f);
+
+                        processor.processBlock(block, midi);
+                    }
+
+                    // a slider drag moves the curve every frame, otherwise only the spectrum changes
+                    if (dragging)
+                        peakGain->setValueNotifyingHost(0.5f + 0.4f * std::sin(float(i) * 0.1f));
+
+                    component.updateFrame();
+
+                    auto start = juce::Time::getHighResolutionTicks();
+                    {
+                        juce::Graphics g (frame);
+                        component.paint(g);
+                    }
+                    auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+                    // the first frame fills the caches, leave it out of steady state
+                    if (i > 0)
+                        frameMs.push_back(seconds * 1000.0);
+                }
+
+                Distribution<double> stats (std::move(frameMs));
+                auto sizeText = juce::String(size.x) + "x" + juce::String(size.y);
+                std::printf("%-10s %-10s %-20s %12.3f %12.3f\n", sizeText.toRawUTF8(), dragging ? "dragging" : "steady",
+                            setup.name, stats.getMean(), stats.getPercentile(0.99));
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    SpectrumBallisticsBenchmark.cpp
+    Times each SpectrumBallistics mode per frame next to the FFT + dB stage
+    it runs after, so the smoothing cost can be read as a share of the analyzer.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "SpectrumKernels.h"
+#include "SpectrumBallistics.h"
+#include "BenchmarkUtils.h"
+
+#include <cstdio>
+
+int main()
+{
+    const float negativeInfinity = -48.f;
+    const int iterations = 5000;
+    const float frameSeconds = 1.f / 60.f;
+    juce::Random random (1234);
+
+    const std::pair<AnalyzerBallistics, const char*> modes[] =
+    {
+        { Ballistics_Raw, "Raw" },
+        { Ballistics_Average, "Average" },
+        { Ballistics_PeakHold, "Peak Hold" },
+        { Ballistics_Decay, "Decay" },
+    };
+
+    std::printf("%-6s %-6s %14s %-10s %14s %9s\n", "order", "bins", "fft+dB ns", "mode", "ballistics ns", "% of fft");
+
+    for (auto order : { 12, 13 }) // FFTOrder::order4096, order8192
+    {
+        const auto fftSize = 1 << order;
+        const auto numBins = fftSize / 2;
+
+        juce::dsp::FFT fft (order);
+        std::vector<float> input ((size_t) fftSize * 2, 0.f), fftData (input);
+        for (int i = 0; i < fftSize; ++i)
+            input[(size_t) i] = random.nextFloat() * 2.f - 1.f;
+
+        // the analysis every mode sits on top of
+        auto fftNs = nanosecondsPerCall(iterations, [&]
+        {
+            std::copy(input.begin(), input.begin() + fftSize, fftData.begin());
+            fft.performFrequencyOnlyForwardTransform (fftData.data());
+            magnitudesToDecibels(fftData.data(), numBins, 1.f / float(numBins), negativeInfinity);
+        });
+
+        // a handful of different spectra so peak hold and decay keep switching between holding and falling
+        std::vector<std::vector<float>> spectra;
+        for (int s = 0; s < 8; ++s)
+        {
+            std::vector<float> spectrum ((size_t) numBins);
+            for (auto& v : spectrum)
+                v = juce::jmap(random.nextFloat(), negativeInfinity, 0.f);
+            spectra.push_back(std::move(spectrum));
+        }
+
+        std::vector<float> frame ((size_t) numBins);
+
+        auto copyNs = nanosecondsPerCall(iterations, [&, s = 0]() mutable
+        {
+            const auto& spectrum = spectra[(size_t) (s++ & 7)];
+            std::copy(spectrum.begin(), spectrum.end(), frame.begin());
+        });
+
+        for (const auto& [mode, name] : modes)
+        {
+            SpectrumBallistics ballistics;
+            ballistics.prepare(numBins, negativeInfinity);
+            ballistics.setMode(mode);
+
+            auto ballisticsNs = nanosecondsPerCall(iterations, [&, s = 0]() mutable
+            {
+                const auto& spectrum = spectra[(size_t) (s++ & 7)];
+                std::copy(spectrum.begin(), spectrum.end(), frame.begin());
+                ballistics.process(frame.data(), frameSeconds);
+            }) - copyNs;
+
+            std::printf("%-6d %-6d %14.1f %-10s %14.1f %8.2f%%\n", order, numBins, fftNs, name, ballisticsNs, 100.0 * ballisticsNs / fftNs);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    MagnitudeResponse.h
+    Batched |H(e^jw)| of a cascade of first and second order sections over a
+    whole array of frequencies, for drawing the response curve. Each section is
+    turned into the power response polynomials once, after that every point is
+    a few multiply-adds, so the loops vectorize like the ones in SpectrumKernels.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SpectrumKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/*
+ |H(e^jw)|^2 of one section as two quadratics in phi = sin^2(w/2) = (1 - cos(w)) / 2:
+
+   |b0 + b1 z^-1 + b2 z^-2|^2 = (b0 + b1 + b2)^2 - 4 (b0 b1 + 4 b0 b2 + b1 b2) phi + 16 b0 b2 phi^2
+
+ it's the same polynomial as the one in cos(w), just written around w = 0. cut filters put their zeros right
+ there, and expanding around cos(w) = 1 would cancel away most of the precision in the low end.
+ */
+struct SectionPowerResponse
+{
+    double numerator[3] {};
+    double denominator[3] {};
+
+    // 'coefficients' in the juce::dsp::IIR::Coefficients layout: b0..bN then a1..aN, already divided by a0. order is 1 or 2
+    static SectionPowerResponse fromCoefficients(const float* coefficients, int order) noexcept
+    {
+        double b0 = coefficients[0], b1 = coefficients[1], b2 = 0.0;
+        double a1, a2 = 0.0;
+
+        if (order == 2)
+        {
+            b2 = coefficients[2];
+            a1 = coefficients[3];
+            a2 = coefficients[4];
+        }
+        else
+        {
+            a1 = coefficients[2];
+        }
+
+        SectionPowerResponse section;
+        section.numerator[0] = (b0 + b1 + b2) * (b0 + b1 + b2);
+        section.numerator[1] = -4.0 * (b0 * b1 + 4.0 * b0 * b2 + b1 * b2);
+        section.numerator[2] = 16.0 * b0 * b2;
+        section.denominator[0] = (1.0 + a1 + a2) * (1.0 + a1 + a2);
+        section.denominator[1] = -4.0 * (a1 + 4.0 * a2 + a1 * a2);
+        section.denominator[2] = 16.0 * a2;
+        return section;
+    }
+};
+
+struct MagnitudeResponse
+{
+    // builds the per point phi table, only needs redoing when the frequencies or the sample rate change
+    void prepare(const double* frequencies, int numPointsToUse, double sampleRate)
+    {
+        numPoints = numPointsToUse;
+        phi.resize((size_t)numPoints);
+        numerator.resize((size_t)numPoints);
+        denominator.resize((size_t)numPoints);
+
+        for (int i = 0; i < numPoints; ++i)
+        {
+            auto s = std::sin(3.14159265358979323846 * frequencies[i] / sampleRate);
+            phi[(size_t)i] = s * s;
+        }
+
+        sections.reserve(16);
+    }
+
+    int getNumPoints() const { return numPoints; }
+
+    void clearSections() { sections.clear(); }
+    void addSection(const float* coefficients, int order) { sections.push_back(SectionPowerResponse::fromCoefficients(coefficients, order)); }
+
+    /*
+     writes the response of every added section multiplied together, in decibels, clamped to 'negativeInfinity'.
+     matches juce::Decibels::gainToDecibels of the product of getMagnitudeForFrequency() to within fastLog10's error.
+     */
+    void process(double* decibels, double negativeInfinity = -100.0)
+    {
+        const auto* phiData = phi.data();
+        auto* num = numerator.data();
+        auto* den = denominator.data();
+
+        std::fill(numerator.begin(), numerator.end(), 1.0);
+        std::fill(denominator.begin(), denominator.end(), 1.0);
+
+        // one pass per section, a single divide per point at the end
+        for (const auto& section : sections)
+        {
+            const auto n0 = section.numerator[0], n1 = section.numerator[1], n2 = section.numerator[2];
+            const auto d0 = section.denominator[0], d1 = section.denominator[1], d2 = section.denominator[2];
+
+            for (int i = 0; i < numPoints; ++i)
+            {
+                const auto p = phiData[i];
+                num[i] *= n0 + p * (n1 + p * n2);
+                den[i] *= d0 + p * (d1 + p * d2);
+            }
+        }
+
+        // clamp in the power domain, positive floats order the same way as their bit patterns
+        const auto floorPower = (float)std::pow(10.0, negativeInfinity / 10.0);
+        std::int32_t floorBits;
+        std::memcpy(&floorBits, &floorPower, sizeof(floorBits));
+
+        for (int i = 0; i < numPoints; ++i)
+        {
+            auto power = (float)(num[i] / den[i]);
+
+            std::int32_t bits;
+            std::memcpy(&bits, &power, sizeof(bits));
+            bits = bits > floorBits ? bits : floorBits;
+            std::memcpy(&power, &bits, sizeof(power));
+
+            decibels[i] = 10.0 * (double)fastLog10(power);
+        }
+    }
+
+private:
+    int numPoints = 0;
+    std::vector<double> phi, numerator, denominator;
+    std::vector<SectionPowerResponse> sections;
+};
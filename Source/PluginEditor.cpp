@@ -67,8 +67,7 @@ float rotaryStartAngle, float rotaryEndAngle, juce::Slider & slider)
         // g.setFont(Font(roboto_font.getTypefaceName(), 15, 1));
         // const juce::Typeface::Ptr typeface = juce::Typeface::createSystemTypefaceFor(BinaryData::RobotoRegular_ttf,BinaryData::RobotoRegular_ttfSize);
         // g.setFont(juce::Font(typeface).withHeight(17.0f));
-        const juce::Typeface::Ptr typeface = juce::Typeface::createSystemTypefaceFor(BinaryData::Orbitron_ttf, BinaryData::Orbitron_ttfSize);
-        g.setFont(juce::Font(typeface).withHeight(15.5f)); // slider labels
+        g.setFont(juce::Font(typefaces->orbitron).withHeight(15.5f)); // slider labels
         g.drawFittedText(text, r.toNearestInt(), Justification::centred, 1);
     }
 }
@@ -225,10 +224,8 @@ juce::String RotarySliderWithLabels::getDisplayString() const
 }
 //==============================================================================
 ResponseCurveComponent::ResponseCurveComponent(EQPluginAudioProcessor& p) : 
-audioProcessor(p),
+audioProcessor(p)
 //leftChannelFifo(&audioProcessor.leftChannelFifo)
-leftPathProducer(audioProcessor.leftChannelFifo),
-rightPathProducer(audioProcessor.rightChannelFifo)
 {
     const auto& params = audioProcessor.getParameters();
     for (auto param: params)
@@ -237,12 +234,14 @@ rightPathProducer(audioProcessor.rightChannelFifo)
     }
 
     updateChain();
-
-    startTimerHz(165); // refresh rate
+    startAnalyzerInBackground();
 }
 
 ResponseCurveComponent::~ResponseCurveComponent()
 {
+    // a build still running holds a reference to the processor, which can go away right after the editor
+    analyzerBuilder.removeAllJobs(true, -1);
+
     const auto& params = audioProcessor.getParameters();
     for (auto param: params)
     {
@@ -250,46 +249,337 @@ ResponseCurveComponent::~ResponseCurveComponent()
     }
 }
 
+void ResponseCurveComponent::startAnalyzerInBackground()
+{
+    // two 8192 point analyzers with their histories and FIFOs are the bulk of opening the editor,
+    // so they're built off the message thread and handed back once they're ready
+    juce::Component::SafePointer<ResponseCurveComponent> safeThis (this);
+    auto& processor = audioProcessor;
+
+    analyzerBuilder.addJob([safeThis, &processor]
+    {
+        // the constructors only allocate, nothing in here touches the processor's FIFOs yet
+        auto built = std::make_shared<Analyzer>(processor);
+
+        juce::MessageManager::callAsync([safeThis, built]
+        {
+            if (auto* comp = safeThis.getComponent())
+                comp->attachAnalyzer(built);
+        });
+    });
+}
+
+void ResponseCurveComponent::startAnalyzerNow()
+{
+    if (analyzer == nullptr)
+        attachAnalyzer(std::make_shared<Analyzer>(audioProcessor));
+}
+
+void ResponseCurveComponent::attachAnalyzer(std::shared_ptr<Analyzer> builtAnalyzer)
+{
+    // startAnalyzerNow() may have beaten the background build to it
+    if (analyzer != nullptr)
+        return;
+
+    analyzer = std::move(builtAnalyzer);
+    analyzerReadyTimeMs = juce::Time::getMillisecondCounterHiRes();
+    framesSinceOrderChange = 0;
+    idle = false;
+    repaint();
+}
+
 void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float newValue)
 {
     parametersChanged.set(true);
 }
 
-void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
+HalfBandDecimator::HalfBandDecimator()
+{
+    // windowed sinc at half the input nyquist, beta 5.65 gives ~60dB of stopband
+    std::array<float, numTaps> window;
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), (size_t)numTaps, juce::dsp::WindowingFunction<float>::kaiser, false, 5.65f);
+
+    float sum = window[centre] * 0.5f;
+    for (size_t i = 0; i < sideTaps.size(); ++i)
+    {
+        auto offset = int(i) * 2 + 1;
+        auto x = juce::MathConstants<float>::halfPi * float(offset);
+        sideTaps[i] = 0.5f * (std::sin(x) / x) * window[centre + offset];
+        sum += 2.f * sideTaps[i];
+    }
+
+    // unity gain at DC
+    centreTap = window[centre] * 0.5f / sum;
+    for (auto& tap : sideTaps)
+        tap /= sum;
+}
+
+void HalfBandDecimator::reset()
+{
+    delay.fill(0.f);
+    delayIndex = 0;
+    skipNext = false;
+}
+
+int HalfBandDecimator::process(const float* input, int numSamples, float* output)
+{
+    int numOutput = 0;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        delay[(size_t)delayIndex] = input[i];
+        delay[(size_t)(delayIndex + numTaps)] = input[i];
+        delayIndex = (delayIndex + 1) % numTaps;
+
+        skipNext = ! skipNext;
+        if (! skipNext)
+            continue;
+
+        // oldest sample is at delayIndex, the newest numTaps - 1 after it
+        const auto* x = delay.data() + delayIndex;
+        auto y = centreTap * x[centre];
+
+        for (size_t j = 0; j < sideTaps.size(); ++j)
+        {
+            auto offset = int(j) * 2 + 1;
+            y += sideTaps[j] * (x[centre - offset] + x[centre + offset]);
+        }
+
+        output[numOutput++] = y;
+    }
+
+    return numOutput;
+}
+
+MultiResolutionAnalyzer::MultiResolutionAnalyzer()
 {
+    for (auto& level : levels)
+    {
+        level.fftDataGenerator.changeOrder(levelOrder);
+        level.history.resize((size_t)level.fftDataGenerator.getFFTSize(), 0.f);
+        level.ballistics.prepare(level.fftDataGenerator.getFFTSize() / 2, -48.f);
+    }
+}
+
+void MultiResolutionAnalyzer::reset()
+{
+    for (auto& level : levels)
+    {
+        level.decimator.reset();
+        std::fill(level.history.begin(), level.history.end(), 0.f);
+        level.writeIndex = 0;
+        level.newSamples = 0;
+        level.hasSpectrum = false;
+        level.ballistics.reset();
+    }
+}
+
+void MultiResolutionAnalyzer::setBallistics(AnalyzerBallistics mode)
+{
+    for (auto& level : levels)
+        level.ballistics.setMode(mode);
+}
+
+void MultiResolutionAnalyzer::pushIntoHistory(Level& level, const float* samples, int numSamples)
+{
+    const auto historySize = (int)level.history.size();
+
+    if (numSamples > historySize)
+    {
+        samples += numSamples - historySize;
+        numSamples = historySize;
+    }
+
+    const auto firstSize = juce::jmin(numSamples, historySize - level.writeIndex);
+    juce::FloatVectorOperations::copy(level.history.data() + level.writeIndex, samples, firstSize);
+    juce::FloatVectorOperations::copy(level.history.data(), samples + firstSize, numSamples - firstSize);
+
+    level.writeIndex = (level.writeIndex + numSamples) % historySize;
+    level.newSamples += numSamples;
+}
+
+void MultiResolutionAnalyzer::push(const float* samples, int numSamples)
+{
+    if (decimated.size() < (size_t)numSamples)
+    {
+        decimated.resize((size_t)numSamples);
+        scratch.resize((size_t)numSamples);
+    }
+
+    pushIntoHistory(levels[0], samples, numSamples);
+
+    const float* source = samples;
+    for (size_t i = 1; i < levels.size(); ++i)
+    {
+        auto& level = levels[i];
+        auto numDecimated = level.decimator.process(source, numSamples, decimated.data());
+        pushIntoHistory(level, decimated.data(), numDecimated);
+
+        // this level's output is the next level's input
+        std::swap(decimated, scratch);
+        source = scratch.data();
+        numSamples = numDecimated;
+    }
+}
+
+void MultiResolutionAnalyzer::process(float negativeInfinity, double sampleRate)
+{
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        auto levelRate = sampleRate / double(1 << i);
+        auto& level = levels[i];
+        auto& generator = level.fftDataGenerator;
+
+        // the top level keeps up with the display, the slower ones only when a quarter of their window is new
+        const auto hopSize = i == 0 ? 1 : generator.getFFTSize() / 4;
+        if (level.newSamples < hopSize)
+            continue;
+
+        auto elapsedSeconds = float(level.newSamples / levelRate);
+        level.newSamples = 0;
+        generator.produceFFTDataForRendering(level.history.data(), (int)level.history.size(), level.writeIndex, negativeInfinity);
+
+        while (generator.getNumAvailableFFTDataBlocks() > 0)
+        {
+            if (generator.getFFTData(level.spectrum))
+            {
+                level.ballistics.process(level.spectrum.data(), elapsedSeconds);
+                level.hasSpectrum = true;
+            }
+        }
+    }
+}
+
+size_t MultiResolutionAnalyzer::getMemoryBytes() const
+{
+    auto bytes = approximateBytes(decimated) + approximateBytes(scratch);
+
+    for (const auto& level : levels)
+        bytes += approximateBytes(level.history) + approximateBytes(level.spectrum)
+               + level.fftDataGenerator.getMemoryBytes() + level.ballistics.getMemoryBytes();
+
+    return bytes;
+}
+
+void MultiResolutionAnalyzer::getBands(std::vector<SpectrumBand>& bands, double sampleRate) const
+{
+    bands.clear();
+
+    // level i covers [0.2, 0.4) * sampleRate / 2^i, which keeps it inside the decimator's flat passband.
+    // the top level takes everything above that and the bottom one everything below
+    for (int i = numLevels - 1; i >= 0; --i)
+    {
+        const auto& level = levels[(size_t)i];
+        if (! level.hasSpectrum)
+            continue;
+
+        auto levelRate = sampleRate / double(1 << i);
+        auto fftSize = level.fftDataGenerator.getFFTSize();
+
+        bands.push_back({ level.spectrum.data(),
+                          fftSize,
+                          float(levelRate / fftSize),
+                          i == numLevels - 1 ? 0.f : float(0.2 * levelRate),
+                          i == 0 ? std::numeric_limits<float>::max() : float(0.4 * levelRate) });
+    }
+}
+
+void PathProducer::pushIntoHistory(const float* samples, int numSamples)
+{
+    const auto historySize = monoBuffer.getNumSamples();
+
+    // only the newest historySize samples can ever be looked at
+    if (numSamples > historySize)
+    {
+        samples += numSamples - historySize;
+        numSamples = historySize;
+    }
+
+    auto* history = monoBuffer.getWritePointer(0);
+    const auto firstSize = juce::jmin(numSamples, historySize - writeIndex);
+
+    juce::FloatVectorOperations::copy(history + writeIndex, samples, firstSize);
+    juce::FloatVectorOperations::copy(history, samples + firstSize, numSamples - firstSize);
+
+    writeIndex = (writeIndex + numSamples) % historySize;
+    hasNewSamples = true;
+    samplesSinceLastFFT += numSamples;
+}
+
+bool PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
+{
+    EQ_TRACE_SCOPE("analyzer", "PathProducer::process");
+
     juce::AudioBuffer<float> tempIncomingBuffer; // create temp buffer to hold buffer if exists
     
-    //while there are buffers to pull from SCF, prepapre to send to FFT generator
+    // the host can call prepareToPlay while the editor is open, leave the FIFO alone until it's done
+    if (! leftChannelFifo->isPrepared())
+        return false;
+
+    //while there are buffers to pull from SCF, write them into the circular history
     while (leftChannelFifo->getNumCompleteBuffersAvailable() > 0)
     {
         if (leftChannelFifo->getAudioBuffer(tempIncomingBuffer))
         {
-            //shifting all the blocks in the buffer one to the left as they are updated in gui
-            auto size = tempIncomingBuffer.getNumSamples();
+            pushIntoHistory(tempIncomingBuffer.getReadPointer(0), tempIncomingBuffer.getNumSamples());
 
-            juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, 0), 
-            monoBuffer.getReadPointer(0, size), 
-            monoBuffer.getNumSamples() - size);
+            if (multiResolution)
+                multiResolutionAnalyzer.push(tempIncomingBuffer.getReadPointer(0), tempIncomingBuffer.getNumSamples());
 
-            juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, monoBuffer.getNumSamples() - size),
-            tempIncomingBuffer.getReadPointer(0, 0),
-            size);
-
-            leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer, -48.f);
+            // anything above -96dB counts as signal, that's way under the analyzer's floor after the FFT scaling
+            if (tempIncomingBuffer.getMagnitude(0, 0, tempIncomingBuffer.getNumSamples()) > 1.0e-5f)
+                samplesSinceSignal = 0;
+            else
+                samplesSinceSignal += tempIncomingBuffer.getNumSamples();
         }
     }
 
-    //while FTT buffers have been prepared, generate a path
-    const auto fftSize = leftChannelFFTDataGenerator.getFFTSize();
-    // 48000 (sample rate) / 2048 (bins) = 23hz (bin width)
-    const auto binWidth = sampleRate / (double)fftSize; // audioProcessor.getSampleRate()
+    // only the newest path ever gets displayed, so one FFT over the latest history is all we need
+    if (! hasNewSamples)
+        return false;
+
+    hasNewSamples = false;
+
+    // after silence, the path stops moving once the last signal has left the longest window (the deepest
+    // multi-res level spans twice the history) and the ballistics have fallen to the floor
+    const auto settleSamples = 2 * monoBuffer.getNumSamples() + int(ballistics.getSettleTimeSeconds(48.f) * sampleRate);
+    if (samplesSinceSignal > settleSamples)
+        return false;
+
+    // how much audio the ballistics should account for since the last spectrum
+    const auto elapsedSeconds = float(samplesSinceLastFFT / sampleRate);
+    samplesSinceLastFFT = 0;
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    if (multiResolution)
+    {
+        multiResolutionAnalyzer.process(-48.f, sampleRate);
+        multiResolutionAnalyzer.getBands(multiResolutionBands, sampleRate);
 
-    while (leftChannelFFTDataGenerator.getNumAvailableFFTDataBlocks() > 0)
+        if (! multiResolutionBands.empty())
+            pathProducer.generatePath(multiResolutionBands, fftBounds, -48.f);
+    }
+    else
     {
-        std::vector<float> fftData;
-        if (leftChannelFFTDataGenerator.getFFTData(fftData))   
+        leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer.getReadPointer(0), monoBuffer.getNumSamples(), writeIndex, -48.f);
+
+        //while FTT buffers have been prepared, generate a path
+        const auto fftSize = leftChannelFFTDataGenerator.getFFTSize();
+        // 48000 (sample rate) / 2048 (bins) = 23hz (bin width)
+        const auto binWidth = sampleRate / (double)fftSize; // audioProcessor.getSampleRate()
+
+        while (leftChannelFFTDataGenerator.getNumAvailableFFTDataBlocks() > 0)
         {
-            pathProducer.generatePath(fftData, fftBounds, fftSize, binWidth, -48.f);
+            std::vector<float> fftData;
+            if (leftChannelFFTDataGenerator.getFFTData(fftData))   
+            {
+                if (ballistics.getNumBins() != fftSize / 2)
+                    ballistics.prepare(fftSize / 2, -48.f);
+
+                ballistics.process(fftData.data(), elapsedSeconds);
+                pathProducer.generatePath(fftData, fftBounds, fftSize, binWidth, -48.f);
+            }
         }
     }
 
@@ -299,111 +589,295 @@ void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
     {
         pathProducer.getPath(leftChannelFFTPath);
     }
+
+    auto costMs = 1000.0 * juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    analysisCostMs += 0.1 * (costMs - analysisCostMs);
+
+    return true;
+}
+
+void PathProducer::changeOrder(FFTOrder newOrder)
+{
+    if (newOrder == getOrder())
+        return;
+
+    // the history is already big enough for any order, so just redo the FFT at the new size next time round
+    leftChannelFFTDataGenerator.changeOrder(newOrder);
+    analysisCostMs = 0.0;
+    hasNewSamples = true;
+    samplesSinceSignal = 0;
+}
+
+void PathProducer::setMultiResolution(bool shouldUseMultiResolution)
+{
+    if (shouldUseMultiResolution == multiResolution)
+        return;
+
+    // the decimated levels only get fed while this is on, so start them again from silence
+    multiResolution = shouldUseMultiResolution;
+    multiResolutionAnalyzer.reset();
+    analysisCostMs = 0.0;
+    hasNewSamples = true;
+    samplesSinceSignal = 0;
+}
+
+size_t PathProducer::getMemoryBytes() const
+{
+    return approximateBytes(monoBuffer)
+         + leftChannelFFTDataGenerator.getMemoryBytes()
+         + ballistics.getMemoryBytes()
+         + pathProducer.getMemoryBytes()
+         + multiResolutionAnalyzer.getMemoryBytes()
+         + multiResolutionBands.capacity() * sizeof(SpectrumBand)
+         + approximateBytes(leftChannelFFTPath);
 }
 
-void ResponseCurveComponent::timerCallback()
+void PathProducer::setBallistics(AnalyzerBallistics mode)
 {
-    if (shouldShowFFTAnalysis)
+    if (mode == ballistics.getMode())
+        return;
+
+    ballistics.setMode(mode);
+    multiResolutionAnalyzer.setBallistics(mode);
+    hasNewSamples = true;
+    samplesSinceSignal = 0;
+}
+
+size_t ResponseCurveComponent::getMemoryBytes() const
+{
+    return (analyzer != nullptr ? analyzer->left.getMemoryBytes() + analyzer->right.getMemoryBytes() : 0)
+         + backgroundLayer.getMemoryBytes()
+         + responseCurveLayer.getMemoryBytes()
+         + CachedLayer::approximateImageBytes(spectrumImage)
+         + approximateBytes(physicalColumnYs)
+         + responseCurveMags.capacity() * sizeof(double)
+         + approximateBytes(responseCurve);
+}
+
+FFTOrder ResponseCurveComponent::chooseAnalyzerOrder(AnalyzerResolution resolution)
+{
+    switch (resolution)
     {
+        case Resolution_2048: return FFTOrder::order2048;
+        case Resolution_4096: return FFTOrder::order4096;
+        case Resolution_8192: return FFTOrder::order8192;
+        case Resolution_Auto: break;
+        case Resolution_MultiRes: break;
+    }
+
+    // small editors can't show the extra bins anyway, so cap the order by the width we're drawing into
+    auto width = getAnalysisArea().getWidth();
+    auto widthOrder = width < 400 ? FFTOrder::order2048 : (width < 800 ? FFTOrder::order4096 : FFTOrder::order8192);
+
+    auto order = analyzer->left.getOrder();
+    if (order > widthOrder)
+        return widthOrder;
+
+    // give the cost measurement time to settle at the current order before moving again
+    const int framesToSettle = 30;
+    if (framesSinceOrderChange < framesToSettle)
+        return order;
+
+    // budget for both channels per frame, doubling the order roughly doubles the cost so leave headroom before stepping up
+    const double budgetMs = 1.0;
+    auto costMs = analyzer->left.getAnalysisCostMs() + analyzer->right.getAnalysisCostMs();
+
+    if (costMs > budgetMs && order > FFTOrder::order2048)
+        return static_cast<FFTOrder>(order - 1);
+
+    if (costMs * 2.5 < budgetMs && order < widthOrder)
+        return static_cast<FFTOrder>(order + 1);
+
+    return order;
+}
+
+void ResponseCurveComponent::updateAnalyzerSettings()
+{
+    auto ballisticsMode = static_cast<AnalyzerBallistics>(audioProcessor.apvts.getRawParameterValue("Analyzer Ballistics")->load());
+    analyzer->left.setBallistics(ballisticsMode);
+    analyzer->right.setBallistics(ballisticsMode);
+
+    auto resolution = static_cast<AnalyzerResolution>(audioProcessor.apvts.getRawParameterValue("Analyzer Resolution")->load());
+
+    auto multiResolution = resolution == Resolution_MultiRes;
+    analyzer->left.setMultiResolution(multiResolution);
+    analyzer->right.setMultiResolution(multiResolution);
+
+    if (multiResolution)
+        return;
+
+    auto order = chooseAnalyzerOrder(resolution);
+
+    if (order == analyzer->left.getOrder())
+    {
+        ++framesSinceOrderChange;
+        return;
+    }
+
+    // producers only ever run on the message thread, so swapping the order here can't race the FFT
+    analyzer->left.changeOrder(order);
+    analyzer->right.changeOrder(order);
+    framesSinceOrderChange = 0;
+}
+
+void ResponseCurveComponent::onVBlank()
+{
+    // nothing to draw into, the analyzer FIFOs just drop blocks until we're back
+    if (! isShowing())
+        return;
+
+    auto now = juce::Time::getMillisecondCounterHiRes();
+
+    if (now - fpsWindowStartMs >= 1000.0)
+    {
+        framesPerSecond = paintsThisSecond * 1000.0 / (now - fpsWindowStartMs);
+        paintsThisSecond = 0;
+        fpsWindowStartMs = now;
+    }
+
+    // once nothing is moving only poll a few times a second, parameter changes still get picked up on the next refresh
+    const double idleUpdateIntervalMs = 100.0;
+    if (idle && ! parametersChanged.get() && now - lastUpdateMs < idleUpdateIntervalMs)
+    {
+        ++skippedRepaints;
+        return;
+    }
+
+    lastUpdateMs = now;
+
+    if (updateFrame())
+    {
+        idle = false;
+        repaint();
+    }
+    else
+    {
+        idle = true;
+        ++skippedRepaints;
+    }
+}
+
+bool ResponseCurveComponent::updateFrame()
+{
+    bool changed = false;
+
+    if (shouldShowFFTAnalysis && analyzer != nullptr)
+    {
+        updateAnalyzerSettings();
+
         auto fftBounds = getAnalysisArea().toFloat();
         auto sampleRate = audioProcessor.getSampleRate();
 
-        leftPathProducer.process(fftBounds, sampleRate);
-        rightPathProducer.process(fftBounds, sampleRate);
+        // both channels have to be drained, so don't let the first one short circuit the second
+        auto leftChanged = analyzer->left.process(fftBounds, sampleRate);
+        auto rightChanged = analyzer->right.process(fftBounds, sampleRate);
+        changed = leftChanged || rightChanged;
     }
 
-    if( parametersChanged.compareAndSetBool(false, true))
+    // the coefficients were designed for the old rate, so a host rate change needs the chain rebuilt too
+    if( parametersChanged.compareAndSetBool(false, true) || audioProcessor.getSampleRate() != chainSampleRate )
     {
         // DBG( "params changed"); // debug
         // update monochain
         updateChain();
-        // signal repaint
-        //repaint(); // now we need to repaint all the time instead of when params change
+        changed = true;
     }
 
-    repaint();
+    return changed;
 }
 
 void ResponseCurveComponent::updateChain() 
 {
     auto chainSettings = getChainSettings(audioProcessor.apvts);
+    chainSampleRate = audioProcessor.getSampleRate();
+    responseCurveNeedsUpdate = true;
 
     monoChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
     monoChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
     monoChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
 
-    auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
+    auto peakCoefficients = makePeakFilter(chainSettings, chainSampleRate);
     updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
 
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
+    auto lowCutCoefficients = makeLowCutFilter(chainSettings, chainSampleRate);
+    auto highCutCoefficients = makeHighCutFilter(chainSettings, chainSampleRate);
 
     updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
     updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
 }
 
-void ResponseCurveComponent::paint (juce::Graphics& g)
+void ResponseCurveComponent::updateResponseCurve()
 {
     using namespace juce;
-    g.fillAll (juce::Colours::black);
-
-    g.drawImage(background, getLocalBounds().toFloat());
 
     auto responseArea = getAnalysisArea();
 
     auto w = responseArea.getWidth();
 
+    // nothing to build until we've been given a size
+    if (w <= 0)
+    {
+        responseCurve.clear();
+        return;
+    }
+
     auto& lowcut = monoChain.get<ChainPositions::LowCut>();
     auto& peak = monoChain.get<ChainPositions::Peak>();
     auto& highcut = monoChain.get<ChainPositions::HighCut>();
 
-    auto sampleRate = audioProcessor.getSampleRate();
+    // one frequency per pixel of the gui's bounds, mapped from 'pixel' space to 'freq' space across the hearing range
+    if (magnitudeResponse.getNumPoints() != w || magnitudeResponseSampleRate != chainSampleRate)
+    {
+        std::vector<double> freqs ((size_t)w);
+        for (int i = 0; i < w; ++i)
+            freqs[(size_t)i] = mapToLog10(double(i) / double(w), 20.0, 20000.0);
+
+        magnitudeResponse.prepare(freqs.data(), w, chainSampleRate);
+        magnitudeResponseSampleRate = chainSampleRate;
+    }
 
-    std::vector<double> mags;
+    magnitudeResponse.clearSections();
 
-    mags.resize(w);
-    
-    // setting the magnitude of frequency per pixel of the gui's bounds
-    for (int i = 0; i < w; ++i)
+    auto addSection = [this](const Filter& filter)
     {
-        // gain not db
-        double mag = 1.f;
-        // get magnitude of pixel mapped from 'pixel' space to 'freq' space, map normalized pixel num to freq in hearing range
-        auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
-
-        if (!monoChain.isBypassed<ChainPositions::Peak>() )
-            mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
+        magnitudeResponse.addSection(filter.coefficients->getRawCoefficients(), (int)filter.coefficients->getFilterOrder());
+    };
 
-        if (!monoChain.isBypassed<ChainPositions::LowCut>())
-        {
-            if (! lowcut.isBypassed<0>() )
-                mag *= lowcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (! lowcut.isBypassed<1>() )
-                mag *= lowcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (! lowcut.isBypassed<2>() )
-                mag *= lowcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (! lowcut.isBypassed<3>() )
-                mag *= lowcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
+    if (!monoChain.isBypassed<ChainPositions::Peak>() )
+        addSection(peak);
 
-        if (!monoChain.isBypassed<ChainPositions::HighCut>())
-        {
-            if (! highcut.isBypassed<0>() )
-                mag *= highcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (! highcut.isBypassed<1>() )
-                mag *= highcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (! highcut.isBypassed<2>() )
-                mag *= highcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (! highcut.isBypassed<3>() )
-                mag *= highcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
+    if (!monoChain.isBypassed<ChainPositions::LowCut>())
+    {
+        if (! lowcut.isBypassed<0>() )
+            addSection(lowcut.get<0>());
+        if (! lowcut.isBypassed<1>() )
+            addSection(lowcut.get<1>());
+        if (! lowcut.isBypassed<2>() )
+            addSection(lowcut.get<2>());
+        if (! lowcut.isBypassed<3>() )
+            addSection(lowcut.get<3>());
+    }
 
-        mags[i] = Decibels::gainToDecibels(mag);
+    if (!monoChain.isBypassed<ChainPositions::HighCut>())
+    {
+        if (! highcut.isBypassed<0>() )
+            addSection(highcut.get<0>());
+        if (! highcut.isBypassed<1>() )
+            addSection(highcut.get<1>());
+        if (! highcut.isBypassed<2>() )
+            addSection(highcut.get<2>());
+        if (! highcut.isBypassed<3>() )
+            addSection(highcut.get<3>());
     }
 
+    // all sections at every pixel in one batch, straight to decibels
+    auto& mags = responseCurveMags;
+    mags.resize(w);
+    magnitudeResponse.process(mags.data());
+
     // convert vector of mags into a path
 
-    Path responseCurve;
+    responseCurve.clear();
 
     const double outputMin = responseArea.getBottom();
     const double outputMax = responseArea.getY();
@@ -419,17 +893,58 @@ void ResponseCurveComponent::paint (juce::Graphics& g)
         responseCurve.lineTo(responseArea.getX() + i, map(mags[i]) );
     };
 
-    if (shouldShowFFTAnalysis)
+    responseCurveNeedsUpdate = false;
+    responseCurveLayer.invalidate();
+}
+
+void ResponseCurveComponent::paint (juce::Graphics& g)
+{
+    EQ_TRACE_SCOPE("paint", "ResponseCurveComponent::paint");
+
+    ++paintsThisSecond;
+
+    if (responseCurveNeedsUpdate)
+        updateResponseCurve();
+
+    if (! useLayerCache)
+    {
+        drawBackgroundGrid(g);
+        drawSpectrum(g);
+        drawResponseCurve(g);
+        return;
+    }
+
+    // only the spectrum changes every frame, the other two layers are blitted unless something invalidated them
+    backgroundLayer.draw(g, getLocalBounds(), [this](juce::Graphics& lg) { drawBackgroundGrid(lg); });
+    drawSpectrum(g);
+    responseCurveLayer.draw(g, getLocalBounds(), [this](juce::Graphics& lg) { drawResponseCurve(lg); });
+}
+
+void ResponseCurveComponent::drawSpectrum(juce::Graphics& g)
+{
+    using namespace juce;
+
+    auto responseArea = getAnalysisArea();
+
+    // still being built in the background
+    if (analyzer == nullptr)
+        return;
+
+    if (shouldShowFFTAnalysis && spectrumRenderer == SpectrumRenderer::bitmap)
+    {
+        drawSpectrumBitmap(g);
+    }
+    else if (shouldShowFFTAnalysis)
     {
         // PathStrokeType pst(2.f, PathStrokeType::JointStyle::curved);
-        auto leftChannelFFTPath = leftPathProducer.getPath();
+        auto leftChannelFFTPath = analyzer->left.getPath();
         leftChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY() - 2.5));
         
         g.setColour(Colours::blueviolet);
         g.strokePath(leftChannelFFTPath, PathStrokeType(2.f));
         // g.strokePath(leftChannelFFTPath, pst);
 
-        auto rightChannelFFTPath = rightPathProducer.getPath();
+        auto rightChannelFFTPath = analyzer->right.getPath();
         rightChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY() - 2.5));
 
         g.setColour(Colours::darkorange);
@@ -437,7 +952,70 @@ void ResponseCurveComponent::paint (juce::Graphics& g)
         // g.strokePath(rightChannelFFTPath, pst);
         // g.fillPath(rightChannelFFTPath); // fills the spectrum line, but the Y is messed up from the response area
     }
-    
+}
+
+void ResponseCurveComponent::drawSpectrumBitmap(juce::Graphics& g)
+{
+    using namespace juce;
+
+    auto responseArea = getAnalysisArea();
+    if (responseArea.isEmpty())
+        return;
+
+    // drawn at the physical pixel size so a 2x display gets a 2x spectrum, blitted back 1:1
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const auto width = juce::jmax(1, roundToInt(responseArea.getWidth() * scale));
+    const auto height = juce::jmax(1, roundToInt(responseArea.getHeight() * scale));
+
+    if (spectrumImage.getWidth() != width || spectrumImage.getHeight() != height)
+        spectrumImage = Image(Image::ARGB, width, height, true);
+    else
+        spectrumImage.clear(spectrumImage.getBounds());
+
+    {
+        Image::BitmapData data(spectrumImage, Image::BitmapData::readWrite);
+
+        // the image sits on the analysis area, this puts the lines where the path renderer's translation puts them
+        const auto yOffset = -2.5f;
+
+        auto drawChannel = [&](const std::vector<float>& ys, Colour colour)
+        {
+            // the analyzer makes one y per logical column, interpolate them out to one per physical column
+            const auto* columnYs = ys.data();
+            auto numColumns = (int)ys.size();
+
+            if (scale != 1.f && numColumns > 0)
+            {
+                physicalColumnYs.resize((size_t)width);
+
+                for (int x = 0; x < width; ++x)
+                {
+                    auto logicalX = jlimit(0.f, float(numColumns - 1), (float(x) + 0.5f) / scale - 0.5f);
+                    auto left = (int)logicalX;
+                    auto right = jmin(left + 1, numColumns - 1);
+                    auto y = jmap(logicalX - float(left), ys[(size_t)left], ys[(size_t)right]);
+                    physicalColumnYs[(size_t)x] = y * scale;
+                }
+
+                columnYs = physicalColumnYs.data();
+                numColumns = width;
+            }
+
+            auto fill = fillsSpectrum ? colour.withAlpha(0.2f) : Colours::transparentBlack;
+            SpectrumRasterizer::draw(data, columnYs, numColumns, yOffset * scale, 2.f * scale, colour, fill);
+        };
+
+        drawChannel(analyzer->left.getColumnYs(), Colours::blueviolet);
+        drawChannel(analyzer->right.getColumnYs(), Colours::darkorange);
+    }
+
+    CachedLayer::blitAtPhysicalScale(g, spectrumImage, responseArea.getPosition(), scale);
+}
+
+void ResponseCurveComponent::drawResponseCurve(juce::Graphics& g)
+{
+    using namespace juce;
+
     g.setColour(Colours::purple);
     g.drawRoundedRectangle(getRenderArea().toFloat(), 4.f, 1.f);
 
@@ -447,13 +1025,16 @@ void ResponseCurveComponent::paint (juce::Graphics& g)
 
 void ResponseCurveComponent::resized()
 {
-    using namespace juce;
-    background = Image(Image::PixelFormat::RGB, getWidth(), getHeight(), true);
+    responseCurveNeedsUpdate = true;
+    backgroundLayer.invalidate();
+}
 
-    Graphics g(background);
+void ResponseCurveComponent::drawBackgroundGrid(juce::Graphics& g)
+{
+    using namespace juce;
+    g.fillAll (juce::Colours::black);
 
-    const juce::Typeface::Ptr typeface = juce::Typeface::createSystemTypefaceFor(BinaryData::Monomaniac_ttf, BinaryData::Monomaniac_ttfSize);
-    g.setFont(juce::Font(typeface).withHeight(11.0f));
+    g.setFont(juce::Font(typefaces->monomaniac).withHeight(11.0f));
 
     Array<float> freqs
     {
@@ -715,6 +1296,13 @@ EQPluginAudioProcessorEditor::EQPluginAudioProcessorEditor (EQPluginAudioProcess
         addAndMakeVisible(comp);
     }
 
+   #if EQ_ENABLE_PROFILING
+    // after the response curve so they sit on top of it, the meter last so it stays clickable over the overlay
+    addChildComponent(stageProfileOverlay);
+    addAndMakeVisible(cpuLoadMeter);
+    cpuLoadMeter.onClick = [this] { stageProfileOverlay.setVisible(! stageProfileOverlay.isVisible()); };
+   #endif
+
     juce::StringArray stringArray;
     for(int i = 0; i < 4; i++) {
         juce::String str;
@@ -743,6 +1331,14 @@ EQPluginAudioProcessorEditor::EQPluginAudioProcessorEditor (EQPluginAudioProcess
     lowpassBypassButton.setLookAndFeel(&lnf);
     analyzerEnabledButton.setLookAndFeel(&lnf);
 
+    if (auto* resolutionParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("Analyzer Resolution")))
+        analyzerResolutionCombo.addItemList(resolutionParam->choices, 1);
+    analyzerResolutionComboAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts, "Analyzer Resolution", analyzerResolutionCombo);
+
+    if (auto* ballisticsParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("Analyzer Ballistics")))
+        analyzerBallisticsCombo.addItemList(ballisticsParam->choices, 1);
+    analyzerBallisticsComboAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts, "Analyzer Ballistics", analyzerBallisticsCombo);
+
     // for async callbacks need to use a safe pointer to make sure the class (edtior) still exists to use the lambda
     auto safePtr = juce::Component::SafePointer<EQPluginAudioProcessorEditor>(this);
     peakBypassButton.onClick = [safePtr]()
@@ -791,10 +1387,27 @@ EQPluginAudioProcessorEditor::EQPluginAudioProcessorEditor (EQPluginAudioProcess
 
     setSize (650, 650);
     setResizable(true,false);
-    juce::Rectangle<int> r = Desktop::getInstance().getDisplays().getMainDisplay().userArea;
+    // there's no display at all when the editor is built headless (benchmarks, CI), so fall back to a generous limit
+    juce::Rectangle<int> r { 0, 0, 3840, 2160 };
+    if (auto* display = Desktop::getInstance().getDisplays().getPrimaryDisplay())
+        r = display->userArea;
     int x = r.getWidth();
     int y = r.getHeight();
     setResizeLimits(50, 0, x, y);
+
+    constructedMs = juce::Time::getMillisecondCounterHiRes() - constructionStartMs;
+}
+
+EQPluginAudioProcessorEditor::StartupTimings EQPluginAudioProcessorEditor::getStartupTimings() const
+{
+    StartupTimings timings;
+    timings.constructed = constructedMs;
+    timings.firstPaint = firstPaintMs;
+
+    if (auto readyMs = responseCurveComponent.getAnalyzerReadyTimeMs(); readyMs > 0.0)
+        timings.analyzerReady = readyMs - constructionStartMs;
+
+    return timings;
 }
 
 EQPluginAudioProcessorEditor::~EQPluginAudioProcessorEditor()
@@ -807,6 +1420,16 @@ EQPluginAudioProcessorEditor::~EQPluginAudioProcessorEditor()
 
 //==============================================================================
 void EQPluginAudioProcessorEditor::paint (juce::Graphics& g)
+{
+    EQ_TRACE_SCOPE("paint", "EQPluginAudioProcessorEditor::paint");
+
+    chromeLayer.draw(g, getLocalBounds(), [this](juce::Graphics& lg) { drawChrome(lg); });
+
+    if (firstPaintMs < 0.0)
+        firstPaintMs = juce::Time::getMillisecondCounterHiRes() - constructionStartMs;
+}
+
+void EQPluginAudioProcessorEditor::drawChrome (juce::Graphics& g)
 {
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     // g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
@@ -827,8 +1450,7 @@ void EQPluginAudioProcessorEditor::paint (juce::Graphics& g)
     auto bounds = getLocalBounds();
     auto center = bounds.getCentre();
     
-    const juce::Typeface::Ptr typeface = juce::Typeface::createSystemTypefaceFor(BinaryData::Orbitron_ttf, BinaryData::Orbitron_ttfSize);
-    g.setFont(juce::Font(typeface).withHeight(35.0f)); // slider labels
+    g.setFont(juce::Font(typefaces->orbitron).withHeight(35.0f)); // slider labels
     
     String title { "E Q - P L U G I N" };
     g.setFont(30);
@@ -881,6 +1503,8 @@ void EQPluginAudioProcessorEditor::resized()
     // This is generally where you'll want to lay out the positions of any
     // subcomponents in your editor..
 
+    chromeLayer.invalidate(); // the labels follow the slider bounds
+
     auto bounds = getLocalBounds();
 
     auto analyzerEnabledArea = bounds.removeFromTop(25);
@@ -890,6 +1514,13 @@ void EQPluginAudioProcessorEditor::resized()
 
     analyzerEnabledButton.setBounds(analyzerEnabledArea);
 
+    auto analyzerResolutionArea = analyzerEnabledArea.withX(analyzerEnabledArea.getRight() + 5);
+    analyzerResolutionArea.setWidth(getWidth() * 0.12);
+    analyzerResolutionCombo.setBounds(analyzerResolutionArea);
+
+    auto analyzerBallisticsArea = analyzerResolutionArea.withX(analyzerResolutionArea.getRight() + 5);
+    analyzerBallisticsCombo.setBounds(analyzerBallisticsArea);
+
     bounds.removeFromTop(5);
 
     float hRatio = 33.f / 100.f; //JUCE_LIVE_CONSTANT(33) / 100.f; // live values
@@ -897,6 +1528,15 @@ void EQPluginAudioProcessorEditor::resized()
 
     responseCurveComponent.setBounds(responseArea);
 
+   #if EQ_ENABLE_PROFILING
+    // top left corner of the analyzer, under the frequency labels and clear of the dB scale
+    cpuLoadMeter.setBounds(responseArea.getX() + 26, responseArea.getY() + 22, 120, 16);
+
+    // under the meter, as much of the analyzer as the table needs
+    auto overlayArea = responseArea.withTrimmedLeft(26).withTrimmedRight(26).withTrimmedTop(42).withTrimmedBottom(8);
+    stageProfileOverlay.setBounds(overlayArea.withWidth(juce::jmin(overlayArea.getWidth(), 420)).withHeight(juce::jmin(overlayArea.getHeight(), 150)));
+   #endif
+
     // auto bypassArea = getLocalBounds();
     // bypassArea.removeFromTop(bypassArea.getHeight() * hRatio);
     // bypassArea.removeFromTop(5);
@@ -948,6 +1588,8 @@ std::vector<juce::Component*> EQPluginAudioProcessorEditor::getComps()
         &highpassBypassButton, 
         &peakBypassButton,
         &lowpassBypassButton,
-        &analyzerEnabledButton
+        &analyzerEnabledButton,
+        &analyzerResolutionCombo,
+        &analyzerBallisticsCombo
     };
 }
\ No newline at end of file
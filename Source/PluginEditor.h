@@ -10,6 +10,11 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "SpectrumKernels.h"
+#include "SpectrumBallistics.h"
+#include "MagnitudeResponse.h"
+#include "SpectrumRasterizer.h"
+#include "SharedFFTResources.h"
 
 enum FFTOrder
 {
@@ -22,45 +27,37 @@ template<typename BlockType>
 struct FFTDataGenerator
 {
     /**
-     produces the FFT data from an audio buffer.
+     produces the FFT data from the last getFFTSize() samples of a circular history buffer.
+     'writeIndex' is where the next incoming sample would be written, so the newest sample sits just behind it.
+     the history is unwrapped and windowed in the same pass, so nothing is shifted around until a transform is due.
      */
-    void produceFFTDataForRendering(const juce::AudioBuffer<float>& audioData, const float negativeInfinity)
+    void produceFFTDataForRendering(const float* history, int historySize, int writeIndex, const float negativeInfinity)
     {
+        EQ_TRACE_SCOPE("analyzer", "FFTDataGenerator::produceFFTDataForRendering");
+
         const auto fftSize = getFFTSize();
+        jassert(historySize >= fftSize);
+
+        // oldest sample we want is fftSize behind the write position
+        auto readIndex = writeIndex - fftSize;
+        if (readIndex < 0)
+            readIndex += historySize;
+
+        const auto firstSize = juce::jmin(fftSize, historySize - readIndex);
+        const auto secondSize = fftSize - firstSize;
+
+        // first apply a windowing function to our data, unwrapping the history as we go
+        const auto* window = windowTable->data();
+        juce::FloatVectorOperations::multiply(fftData.data(), history + readIndex, window, firstSize);       // [1]
+        juce::FloatVectorOperations::multiply(fftData.data() + firstSize, history, window + firstSize, secondSize);
         
-        fftData.assign(fftData.size(), 0);
-        auto* readIndex = audioData.getReadPointer(0);
-        std::copy(readIndex, readIndex + fftSize, fftData.begin());
-        
-        // first apply a windowing function to our data
-        window->multiplyWithWindowingTable (fftData.data(), fftSize);       // [1]
-        
-        // then render our FFT data..
+        // then render our FFT data.. only the first fftSize floats are read, the rest is scratch space
         forwardFFT->performFrequencyOnlyForwardTransform (fftData.data());  // [2]
         
         int numBins = (int)fftSize / 2;
         
-        //normalize the fft values.
-        for( int i = 0; i < numBins; ++i )
-        {
-            auto v = fftData[i];
-//            fftData[i] /= (float) numBins;
-            if( !std::isinf(v) && !std::isnan(v) )
-            {
-                v /= float(numBins);
-            }
-            else
-            {
-                v = 0.f;
-            }
-            fftData[i] = v;
-        }
-        
-        //convert them to decibels
-        for( int i = 0; i < numBins; ++i )
-        {
-            fftData[i] = juce::Decibels::gainToDecibels(fftData[i], negativeInfinity);
-        }
+        // normalize, throw away inf/nan and convert to decibels in a single vectorized pass
+        magnitudesToDecibels(fftData.data(), numBins, 1.f / float(numBins), negativeInfinity);
         
         fftDataFifo.push(fftData);
     }
@@ -74,34 +71,128 @@ struct FFTDataGenerator
         order = newOrder;
         auto fftSize = getFFTSize();
         
-        forwardFFT = std::make_unique<juce::dsp::FFT>(order);
-        window = std::make_unique<juce::dsp::WindowingFunction<float>>(fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris);
+        // the engine and window are shared with every other analyzer at this order, see SharedFFTResources
+        forwardFFT = SharedFFTResources::getFFT(order);
+
+        // the window is kept as a table so it can be applied while unwrapping the history
+        windowTable = SharedFFTResources::getWindow(fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris);
         
         fftData.clear();
         fftData.resize(fftSize * 2, 0);
 
+        // the newest spectrum is the only one anyone reads
+        fftDataFifo.setPolicy(FifoPolicy::latestOnly);
         fftDataFifo.prepare(fftData.size());
     }
     //==============================================================================
     int getFFTSize() const { return 1 << order; }
+    FFTOrder getOrder() const { return order; }
     int getNumAvailableFFTDataBlocks() const { return fftDataFifo.getNumAvailableForReading(); }
     //==============================================================================
     bool getFFTData(BlockType& fftData) { return fftDataFifo.pull(fftData); }
+
+    // the FFT engine and window are shared, see SharedFFTResources, so they aren't counted here
+    size_t getMemoryBytes() const { return approximateBytes(fftData) + fftDataFifo.getMemoryBytes(); }
 private:
     FFTOrder order;
     BlockType fftData;
-    std::unique_ptr<juce::dsp::FFT> forwardFFT;
-    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    std::shared_ptr<const juce::dsp::FFT> forwardFFT;
+    std::shared_ptr<const std::vector<float>> windowTable;
     
     Fifo<BlockType> fftDataFifo;
 };
 
 
+// one FFT's worth of dB data and the frequency range the analyzer should take from it
+struct SpectrumBand
+{
+    const float* data;
+    int fftSize;
+    float binWidth;
+    float minFreq;
+    float maxFreq;
+};
+
+// decimates by 2 with a 39 tap kaiser windowed half-band, flat to 0.2 * fs in and ~60dB down from 0.3 * fs in
+struct HalfBandDecimator
+{
+    HalfBandDecimator();
+
+    void reset();
+
+    // writes every second filtered sample to 'output', returns how many were written
+    int process(const float* input, int numSamples, float* output);
+
+    static constexpr int numTaps = 39;
+private:
+    static constexpr int centre = numTaps / 2;
+
+    // half-band taps are zero at even offsets from the centre, so only keep the odd ones (they're symmetric too)
+    float centreTap = 0.5f;
+    std::array<float, (centre + 1) / 2> sideTaps {};
+
+    // delay line written twice so the last numTaps samples are always contiguous
+    std::array<float, numTaps * 2> delay {};
+    int delayIndex = 0;
+    bool skipNext = false;
+};
+
+/*
+ runs the same small FFT over successively decimated copies of the signal and stitches them per octave region,
+ level 0 is full rate and covers the top, each level below it halves the rate so its bins are twice as narrow.
+ */
+struct MultiResolutionAnalyzer
+{
+    static constexpr int numLevels = 4;
+    static constexpr FFTOrder levelOrder = FFTOrder::order2048;
+
+    MultiResolutionAnalyzer();
+
+    void reset();
+
+    // feed full rate samples in, decimated copies go to the levels below
+    void push(const float* samples, int numSamples);
+
+    // runs the FFT of every level that has enough new samples
+    void process(float negativeInfinity, double sampleRate);
+
+    void setBallistics(AnalyzerBallistics mode);
+
+    // latest spectrum of each level with the frequency range it's responsible for, lowest frequencies first
+    void getBands(std::vector<SpectrumBand>& bands, double sampleRate) const;
+
+    size_t getMemoryBytes() const;
+
+private:
+    struct Level
+    {
+        HalfBandDecimator decimator; // feeds this level from the one above, level 0 doesn't use it
+        std::vector<float> history;
+        int writeIndex = 0;
+        int newSamples = 0;
+        bool hasSpectrum = false;
+
+        FFTDataGenerator<std::vector<float>> fftDataGenerator;
+        std::vector<float> spectrum;
+        SpectrumBallistics ballistics;
+    };
+
+    std::array<Level, numLevels> levels;
+    std::vector<float> decimated, scratch;
+
+    static void pushIntoHistory(Level& level, const float* samples, int numSamples);
+};
+
 template<typename PathType>
 struct AnalyzerPathGenerator //lol who needs classes with structs
 {
+    // only the newest path is ever drawn
+    AnalyzerPathGenerator() { pathFifo.setPolicy(FifoPolicy::latestOnly); }
+
     /*
      converts 'renderData[]' into a juce::Path
+     bins are reduced to the loudest one per pixel column first, so the path never has more than one point
+     per column however big the FFT is
      */
     void generatePath(const std::vector<float>& renderData,
                       juce::Rectangle<float> fftBounds,
@@ -109,11 +200,49 @@ struct AnalyzerPathGenerator //lol who needs classes with structs
                       float binWidth,
                       float negativeInfinity)
     {
+        singleBand.clear();
+        singleBand.push_back({ renderData.data(), fftSize, binWidth, 0.f, std::numeric_limits<float>::max() });
+
+        generatePath(singleBand, fftBounds, negativeInfinity);
+    }
+
+    /*
+     same again but stitched together from several spectra, each one only contributes the columns inside
+     its own frequency range. 'bands' go from the lowest frequencies up.
+     */
+    void generatePath(const std::vector<SpectrumBand>& bands,
+                      juce::Rectangle<float> fftBounds,
+                      float negativeInfinity)
+    {
+        jassert(! bands.empty());
+
         auto top = fftBounds.getY();
         auto bottom = fftBounds.getHeight();
         auto width = fftBounds.getWidth();
+        int numColumns = (int)width;
 
-        int numBins = (int)fftSize / 2;
+        // reduce every band into one level per column, nan marks a column no bin landed on
+        columnLevels.assign((size_t)juce::jmax(0, numColumns), std::numeric_limits<float>::quiet_NaN());
+
+        if (columnMappings.size() != bands.size())
+            columnMappings.resize(bands.size());
+
+        for( size_t i = 0; i < bands.size(); ++i )
+        {
+            const auto& band = bands[i];
+            auto& mapping = columnMappings[i];
+            mapping.update(numColumns, band.fftSize, band.binWidth, band.minFreq, band.maxFreq);
+
+            for( const auto& span : mapping.spans )
+            {
+                auto level = band.data[span.firstBin];
+                for( int binNum = span.firstBin + 1; binNum <= span.lastBin; ++binNum )
+                    level = juce::jmax(level, band.data[binNum]);
+
+                auto& column = columnLevels[(size_t)span.column];
+                column = std::isnan(column) ? level : juce::jmax(column, level);
+            }
+        }
 
         PathType p;
         p.preallocateSpace(3 * (int)fftBounds.getWidth());
@@ -125,7 +254,7 @@ struct AnalyzerPathGenerator //lol who needs classes with structs
                               float(bottom+10),   top);
         };
 
-        auto y = map(renderData[0]);
+        auto y = map(bands.front().data[0]);
 
 //        jassert( !std::isnan(y) && !std::isinf(y) );
         if( std::isnan(y) || std::isinf(y) )
@@ -133,26 +262,45 @@ struct AnalyzerPathGenerator //lol who needs classes with structs
         
         p.startNewSubPath(0, y);
 
-        const int pathResolution = 2; //you can draw line-to's every 'pathResolution' pixels.
+        // the bitmap renderer gets one y per column, gaps joined up the same way lineTo joins them
+        columnYs.assign((size_t)juce::jmax(0, numColumns), std::numeric_limits<float>::quiet_NaN());
+        if (numColumns > 0)
+            columnYs[0] = y;
 
-        for( int binNum = 1; binNum < numBins; binNum += pathResolution )
-        {
-            y = map(renderData[binNum]);
+        auto previousColumn = 0;
+        auto previousY = y;
 
-//            jassert( !std::isnan(y) && !std::isinf(y) );
+        for( int column = 0; column < numColumns; ++column )
+        {
+            y = map(columnLevels[(size_t)column]);
 
             if( !std::isnan(y) && !std::isinf(y) )
             {
-                auto binFreq = binNum * binWidth;
-                auto normalizedBinX = juce::mapFromLog10(binFreq, 20.f, 20000.f);
-                float binX = std::floor(normalizedBinX * width);
-                p.lineTo(binX, y);
+                p.lineTo(float(column), y);
+
+                for( int gap = previousColumn + 1; gap < column; ++gap )
+                    columnYs[(size_t)gap] = juce::jmap(float(gap), float(previousColumn), float(column), previousY, y);
+
+                columnYs[(size_t)column] = y;
+                previousColumn = column;
+                previousY = y;
             }
         }
 
         pathFifo.push(p);
     }
 
+    // y of the newest spectrum at every pixel column, nan past the last column the path reaches
+    const std::vector<float>& getColumnYs() const { return columnYs; }
+
+    size_t getMemoryBytes() const
+    {
+        auto bytes = pathFifo.getMemoryBytes() + approximateBytes(columnYs) + approximateBytes(columnLevels);
+        for (const auto& mapping : columnMappings)
+            bytes += mapping.spans.capacity() * sizeof(ColumnSpan);
+        return bytes;
+    }
+
     int getNumPathsAvailable() const
     {
         return pathFifo.getNumAvailableForReading();
@@ -164,9 +312,79 @@ struct AnalyzerPathGenerator //lol who needs classes with structs
     }
 private:
     Fifo<PathType> pathFifo;
+    std::vector<float> columnYs;
+
+    // run of neighbouring bins that all land on the same pixel column
+    struct ColumnSpan
+    {
+        int column;
+        int firstBin;
+        int lastBin;
+    };
+
+    // bin -> column table for one band, only rebuilt when the width, FFT size, sample rate or range changes
+    struct ColumnMapping
+    {
+        std::vector<ColumnSpan> spans;
+        int columns = 0, fftSize = 0;
+        float binWidth = 0.f, minFreq = 0.f, maxFreq = 0.f;
+
+        void update(int numColumns, int newFFTSize, float newBinWidth, float newMinFreq, float newMaxFreq)
+        {
+            if (numColumns == columns && newFFTSize == fftSize && newBinWidth == binWidth
+                && newMinFreq == minFreq && newMaxFreq == maxFreq)
+                return;
+
+            columns = numColumns;
+            fftSize = newFFTSize;
+            binWidth = newBinWidth;
+            minFreq = newMinFreq;
+            maxFreq = newMaxFreq;
+
+            spans.clear();
+            spans.reserve((size_t)juce::jmax(0, numColumns));
+
+            int numBins = (int)fftSize / 2;
+
+            for( int binNum = 1; binNum < numBins; ++binNum )
+            {
+                auto binFreq = binNum * binWidth;
+                if (binFreq < minFreq)
+                    continue;
+                if (binFreq >= maxFreq)
+                    break;
+
+                auto normalizedBinX = juce::mapFromLog10(binFreq, 20.f, 20000.f);
+                int column = (int)std::floor(normalizedBinX * numColumns);
+
+                // anything below 20Hz or above 20kHz is off the display
+                if (column < 0)
+                    continue;
+                if (column >= numColumns)
+                    break;
+
+                if (! spans.empty() && spans.back().column == column)
+                    spans.back().lastBin = binNum;
+                else
+                    spans.push_back({ column, binNum, binNum });
+            }
+        }
+    };
+
+    std::vector<ColumnMapping> columnMappings;
+    std::vector<float> columnLevels;
+    std::vector<SpectrumBand> singleBand;
 };
 
 
+// the fonts in BinaryData, parsed once per process and shared. hold a juce::SharedResourcePointer<EmbeddedTypefaces>
+// to use them, they're released when the last holder goes away
+struct EmbeddedTypefaces
+{
+    const juce::Typeface::Ptr orbitron = juce::Typeface::createSystemTypefaceFor(BinaryData::Orbitron_ttf, BinaryData::Orbitron_ttfSize);
+    const juce::Typeface::Ptr monomaniac = juce::Typeface::createSystemTypefaceFor(BinaryData::Monomaniac_ttf, BinaryData::Monomaniac_ttfSize);
+};
+
 struct RotaryLookAndFeel : juce::LookAndFeel_V4
 {
     void drawRotarySlider (juce::Graphics&, // from juce::LookAndFeel_V4 class line 206
@@ -191,6 +409,7 @@ struct RotaryLookAndFeel : juce::LookAndFeel_V4
 
 private:
 //   const juce::Typeface::Ptr typeface = juce::Typeface::createSystemTypefaceFor(BinaryData::RobotoMono_ttf, BinaryData::RobotoMono_ttfSize);
+    juce::SharedResourcePointer<EmbeddedTypefaces> typefaces;
 };
 
 
@@ -234,38 +453,142 @@ struct PathProducer
     PathProducer(SingleChannelSampleFifo<EQPluginAudioProcessor::BlockType>& scsf) : leftChannelFifo(&scsf)
     {
         leftChannelFFTDataGenerator.changeOrder(FFTOrder::order8192);
-        monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize());
+        // history is sized for the biggest order so the resolution can change without losing samples
+        monoBuffer.setSize(1, 1 << FFTOrder::order8192);
+        monoBuffer.clear();
     }
 
-    void process(juce::Rectangle<float> fftBounds, double sampleRate);
+    // returns true if a new path came out. once the input has been silent long enough for the display to settle,
+    // nothing changes any more so the FFT is skipped and this returns false
+    bool process(juce::Rectangle<float> fftBounds, double sampleRate);
     juce::Path getPath() { return leftChannelFFTPath; }
+    const std::vector<float>& getColumnYs() const { return pathProducer.getColumnYs(); }
+
+    // only call these from the same thread as process()
+    void changeOrder(FFTOrder newOrder);
+    FFTOrder getOrder() const { return leftChannelFFTDataGenerator.getOrder(); }
+
+    void setMultiResolution(bool shouldUseMultiResolution);
+    bool isMultiResolution() const { return multiResolution; }
+
+    void setBallistics(AnalyzerBallistics mode);
+
+    // smoothed cost of one FFT + path generation, used by the Auto resolution
+    double getAnalysisCostMs() const { return analysisCostMs; }
+
+    size_t getMemoryBytes() const;
 
 private:
     SingleChannelSampleFifo<EQPluginAudioProcessor::BlockType>* leftChannelFifo;
     
+    // circular history of the most recent samples, 'writeIndex' is where the next sample goes
     juce::AudioBuffer<float> monoBuffer;
+    int writeIndex = 0;
+    bool hasNewSamples = false;
+    int samplesSinceLastFFT = 0;
+    int samplesSinceSignal = 0;
+
+    void pushIntoHistory(const float* samples, int numSamples);
     
     FFTDataGenerator<std::vector<float>> leftChannelFFTDataGenerator;
+    SpectrumBallistics ballistics;
     
     AnalyzerPathGenerator<juce::Path> pathProducer;
+
+    bool multiResolution = false;
+    MultiResolutionAnalyzer multiResolutionAnalyzer;
+    std::vector<SpectrumBand> multiResolutionBands;
     
     juce::Path leftChannelFFTPath;
+
+    double analysisCostMs = 0.0;
+};
+
+// an offscreen image of something that rarely changes, only redrawn after invalidate() or when its bounds change.
+// the image is kept at the physical pixel size of whatever it's drawn into, so on a 2x display it's rendered at 2x
+// and blitted back 1:1 instead of being upscaled
+struct CachedLayer
+{
+    CachedLayer(juce::Image::PixelFormat formatToUse) : format(formatToUse) { }
+
+    void invalidate() { needsRedraw = true; }
+
+    size_t getMemoryBytes() const { return approximateImageBytes(image); }
+
+    static size_t approximateImageBytes(const juce::Image& imageToMeasure)
+    {
+        if (! imageToMeasure.isValid())
+            return 0;
+
+        auto bytesPerPixel = imageToMeasure.getFormat() == juce::Image::ARGB ? 4 : (imageToMeasure.getFormat() == juce::Image::RGB ? 3 : 1);
+        return size_t(imageToMeasure.getWidth()) * size_t(imageToMeasure.getHeight()) * size_t(bytesPerPixel);
+    }
+
+    // redraws through 'drawContent' if needed, then blits the image into 'bounds'.
+    // 'drawContent' draws in the same coordinates as 'g', as if there was no cache
+    template<typename DrawFunction>
+    void draw(juce::Graphics& g, juce::Rectangle<int> bounds, DrawFunction&& drawContent)
+    {
+        if (bounds.isEmpty())
+            return;
+
+        // moving to a display with a different scale needs a new image at the new pixel size
+        const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        const auto physicalWidth = juce::roundToInt(bounds.getWidth() * scale);
+        const auto physicalHeight = juce::roundToInt(bounds.getHeight() * scale);
+
+        if (needsRedraw || scale != lastScale || bounds != lastBounds
+            || image.getWidth() != physicalWidth || image.getHeight() != physicalHeight)
+        {
+            if (image.getWidth() != physicalWidth || image.getHeight() != physicalHeight)
+                image = juce::Image(format, juce::jmax(1, physicalWidth), juce::jmax(1, physicalHeight), true);
+            else
+                image.clear(image.getBounds());
+
+            juce::Graphics layerGraphics(image);
+            layerGraphics.addTransform(juce::AffineTransform::translation(-bounds.toFloat().getPosition()).scaled(scale));
+            drawContent(layerGraphics);
+
+            lastScale = scale;
+            lastBounds = bounds;
+            needsRedraw = false;
+        }
+
+        blitAtPhysicalScale(g, image, bounds.getPosition(), scale);
+    }
+
+    // draws an image made at 'scale' physical pixels per logical one back at 1:1, so there's no resampling
+    static void blitAtPhysicalScale(juce::Graphics& g, const juce::Image& imageToDraw, juce::Point<int> position, float scale)
+    {
+        if (scale == 1.f)
+            g.drawImageAt(imageToDraw, position.x, position.y);
+        else
+            g.drawImageTransformed(imageToDraw, juce::AffineTransform::scale(1.f / scale).translated(position.toFloat()));
+    }
+
+private:
+    juce::Image::PixelFormat format;
+    juce::Image image;
+    juce::Rectangle<int> lastBounds;
+    float lastScale = 0.f;
+    bool needsRedraw = true;
 };
 
 struct ResponseCurveComponent: juce::Component,
-juce::AudioProcessorParameter::Listener,
-juce::Timer
+juce::AudioProcessorParameter::Listener
 {
 
   ResponseCurveComponent(EQPluginAudioProcessor&);
   ~ResponseCurveComponent();
 
-  // callbacks from Listener and Timer definitions
+  // callbacks from Listener definitions
   void parameterValueChanged (int parameterIndex, float newValue) override;
 
   void parameterGestureChanged (int parameterIndex, bool gestureIsStarting) override { }
 
-  void timerCallback() override;
+  // runs the analyzer and picks up parameter changes, returns true if anything on screen changed.
+  // called once per display refresh, public so benchmarks can drive frames without a display
+  bool updateFrame();
 
   void paint(juce::Graphics& g) override;
   void resized() override;
@@ -273,6 +596,38 @@ juce::Timer
   void toggleAnalysisEnablement(bool enabled)
   {
     shouldShowFFTAnalysis = enabled;
+    repaint();
+  }
+
+  // the analyzers are built on a background thread after construction so the editor can show up straight away,
+  // until they're attached the spectrum just isn't drawn. startAnalyzerNow() builds them right here instead,
+  // for benchmarks and anything else that has no message loop to deliver them
+  bool isAnalyzerReady() const { return analyzer != nullptr; }
+  void startAnalyzerNow();
+
+  // Time::getMillisecondCounterHiRes() when the analyzers were attached, 0 until then
+  double getAnalyzerReadyTimeMs() const { return analyzerReadyTimeMs; }
+
+  // analyzer state plus cached images, for EQPluginAudioProcessor::getMemoryReport()
+  size_t getMemoryBytes() const;
+
+  // paints per second over the last second, and how many display refreshes went by without one
+  double getFramesPerSecond() const { return framesPerSecond; }
+  int getSkippedRepaintCount() const { return skippedRepaints; }
+
+  // the bitmap renderer writes the spectrum straight into an image, the path one strokes juce::Paths like it used to
+  enum class SpectrumRenderer { path, bitmap };
+  void setSpectrumRenderer(SpectrumRenderer renderer) { spectrumRenderer = renderer; repaint(); }
+
+  // shades the area under each spectrum line, only the bitmap renderer can do this
+  void setFillsSpectrum(bool shouldFill) { fillsSpectrum = shouldFill; repaint(); }
+
+  // with the cache off every layer is drawn straight into the paint's graphics, handy for comparing frame times
+  void setUsesLayerCache(bool shouldUseLayerCache)
+  {
+    useLayerCache = shouldUseLayerCache;
+    backgroundLayer.invalidate();
+    responseCurveLayer.invalidate();
   }
 private:
     EQPluginAudioProcessor& audioProcessor;
@@ -282,14 +637,68 @@ private:
 
     void updateChain();
 
-    juce::Image background;
+    // the filter curve only changes with the parameters, size or sample rate, so it's built once and reused every paint
+    void updateResponseCurve();
+    std::vector<double> responseCurveMags;
+    MagnitudeResponse magnitudeResponse;
+    double magnitudeResponseSampleRate = 0.0;
+    juce::Path responseCurve;
+    bool responseCurveNeedsUpdate = true;
+    double chainSampleRate = 0.0;
+
+    // paint composites the grid, then the live spectrum, then the response curve on top
+    void drawBackgroundGrid(juce::Graphics& g);
+    void drawSpectrum(juce::Graphics& g);
+    void drawSpectrumBitmap(juce::Graphics& g);
+    void drawResponseCurve(juce::Graphics& g);
+
+    CachedLayer backgroundLayer { juce::Image::RGB };
+    CachedLayer responseCurveLayer { juce::Image::ARGB };
+    bool useLayerCache = true;
+
+    SpectrumRenderer spectrumRenderer = SpectrumRenderer::bitmap;
+    bool fillsSpectrum = false;
+    juce::Image spectrumImage;
+    std::vector<float> physicalColumnYs;
 
     juce::Rectangle<int> getRenderArea();
     juce::Rectangle<int> getAnalysisArea();
 
-    PathProducer leftPathProducer, rightPathProducer;
+    struct Analyzer
+    {
+        Analyzer(EQPluginAudioProcessor& p) : left(p.leftChannelFifo), right(p.rightChannelFifo) { }
+
+        PathProducer left, right;
+    };
+
+    // shared_ptr because it travels through callAsync, which needs copyable lambdas
+    std::shared_ptr<Analyzer> analyzer;
+    double analyzerReadyTimeMs = 0.0;
+
+    void startAnalyzerInBackground();
+    void attachAnalyzer(std::shared_ptr<Analyzer> builtAnalyzer);
+
+    // builds the analyzer off the message thread, the destructor waits for it so the job never outlives the processor
+    juce::ThreadPool analyzerBuilder { 1 };
+
+    FFTOrder chooseAnalyzerOrder(AnalyzerResolution resolution);
+    void updateAnalyzerSettings();
+    int framesSinceOrderChange = 0;
 
     bool shouldShowFFTAnalysis = true;
+
+    juce::SharedResourcePointer<EmbeddedTypefaces> typefaces;
+
+    // refresh scheduling, every display refresh while something is moving, a slow poll once it's all settled
+    void onVBlank();
+    bool idle = false;
+    double lastUpdateMs = 0.0;
+    int skippedRepaints = 0;
+    int paintsThisSecond = 0;
+    double fpsWindowStartMs = 0.0;
+    double framesPerSecond = 0.0;
+
+    juce::VBlankAttachment vblankAttachment { this, [this] { onVBlank(); } };
 };
 
 //==============================================================================
@@ -315,6 +724,140 @@ struct AnalyzerButton : juce::ToggleButton
 
     Path randomPath; // cool random squiggley line
 };
+
+#if EQ_ENABLE_PROFILING
+// average and recent peak load of the audio thread, as a percentage of the real-time budget
+struct CpuLoadMeter : juce::Component, juce::Timer
+{
+    CpuLoadMeter(BlockLoadHistogram& histogramToRead) : histogram(histogramToRead)
+    {
+        setMouseCursor(juce::MouseCursor::PointingHandCursor);
+        startTimerHz(4);
+    }
+
+    // the editor uses it to show and hide the per stage breakdown
+    std::function<void()> onClick;
+
+    void mouseUp(const juce::MouseEvent& e) override
+    {
+        if (onClick != nullptr && getLocalBounds().contains(e.getPosition()))
+            onClick();
+    }
+
+    void timerCallback() override
+    {
+        // a peak sticks around for a couple of seconds, otherwise one slow block is gone before anyone can read it
+        auto peak = histogram.takePeakLoad();
+        if (peak >= heldPeak || ++ticksSincePeak > 8)
+        {
+            heldPeak = peak;
+            ticksSincePeak = 0;
+        }
+
+        auto newText = "CPU " + toPercent(histogram.getAverageLoad()) + "  peak " + toPercent(heldPeak);
+        if (newText != text)
+        {
+            text = newText;
+            repaint();
+        }
+    }
+
+    void paint(juce::Graphics& g) override
+    {
+        g.setColour(juce::Colours::black.withAlpha(0.6f));
+        g.fillRoundedRectangle(getLocalBounds().toFloat(), 3.f);
+
+        // red once a block overran its budget, that's a dropout
+        g.setColour(heldPeak >= 1.f ? juce::Colours::red : juce::Colour(175u, 175u, 175u));
+        g.setFont(juce::Font(typefaces->monomaniac).withHeight(11.f));
+        g.drawFittedText(text, getLocalBounds().reduced(4, 0), juce::Justification::centredLeft, 1);
+    }
+
+private:
+    static juce::String toPercent(float load) { return juce::String(load * 100.f, load < 0.1f ? 1 : 0) + "%"; }
+
+    BlockLoadHistogram& histogram;
+    float heldPeak = 0.f;
+    int ticksSincePeak = 0;
+    juce::String text;
+
+    juce::SharedResourcePointer<EmbeddedTypefaces> typefaces;
+};
+
+// StageProfiler's table with the slope and bypass settings it was measured under, click it to start over
+struct StageProfileOverlay : juce::Component, juce::Timer
+{
+    StageProfileOverlay(EQPluginAudioProcessor& p) : audioProcessor(p) { }
+
+    void visibilityChanged() override
+    {
+        if (isVisible())
+        {
+            refresh();
+            startTimerHz(2);
+        }
+        else
+        {
+            stopTimer();
+        }
+    }
+
+    void timerCallback() override { refresh(); }
+
+    void mouseUp(const juce::MouseEvent&) override
+    {
+        audioProcessor.stageProfiler.reset();
+        audioProcessor.blockLoad.reset();
+        refresh();
+    }
+
+    void paint(juce::Graphics& g) override
+    {
+        g.setColour(juce::Colours::black.withAlpha(0.8f));
+        g.fillRoundedRectangle(getLocalBounds().toFloat(), 4.f);
+
+        g.setColour(juce::Colour(200u, 200u, 200u));
+        g.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 12.f, juce::Font::plain));
+
+        auto area = getLocalBounds().reduced(8, 6);
+        for (const auto& line : lines)
+            g.drawText(line, area.removeFromTop(15), juce::Justification::centredLeft, false);
+    }
+
+private:
+    void refresh()
+    {
+        auto settings = getChainSettings(audioProcessor.apvts);
+        auto describeCut = [](bool bypassed, Slope slope)
+        {
+            return bypassed ? juce::String("bypassed") : juce::String(12 * (slope + 1)) + " dB/oct";
+        };
+
+        juce::StringArray newLines;
+        newLines.add("low cut " + describeCut(settings.lowCutBypassed, settings.lowCutSlope)
+                     + ", peak " + (settings.peakBypassed ? "bypassed" : "on")
+                     + ", high cut " + describeCut(settings.highCutBypassed, settings.highCutSlope));
+
+        auto& load = audioProcessor.blockLoad;
+        newLines.add(juce::String((juce::int64)load.getNumBlocks()) + " blocks, load p50 "
+                     + juce::String(load.getPercentileLoad(0.5) * 100.f, 1) + "% p99 "
+                     + juce::String(load.getPercentileLoad(0.99) * 100.f, 1) + "%, "
+                     + juce::String((juce::int64)load.getNumOverruns()) + " overruns");
+        newLines.addLines(audioProcessor.stageProfiler.getTable());
+        newLines.removeEmptyStrings(false);
+        newLines.insert(2, {}); // gap between the summary and the table
+
+        if (newLines != lines)
+        {
+            lines = newLines;
+            repaint();
+        }
+    }
+
+    EQPluginAudioProcessor& audioProcessor;
+    juce::StringArray lines;
+};
+#endif
 /**
 */
 class EQPluginAudioProcessorEditor  : public juce::AudioProcessorEditor
@@ -327,12 +870,28 @@ public:
     void paint (juce::Graphics&) override;
     void resized() override;
 
+    size_t getMemoryBytes() const { return responseCurveComponent.getMemoryBytes() + chromeLayer.getMemoryBytes(); }
+
+    // milliseconds from the start of construction, -1 for whatever hasn't happened yet
+    struct StartupTimings
+    {
+        double constructed = -1.0;
+        double firstPaint = -1.0;
+        double analyzerReady = -1.0;
+    };
+
+    StartupTimings getStartupTimings() const;
+
 private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
 
     EQPluginAudioProcessor& audioProcessor;
 
+    // first thing initialised, so the startup timings include building every member below
+    const double constructionStartMs = juce::Time::getMillisecondCounterHiRes();
+    double constructedMs = -1.0, firstPaintMs = -1.0;
+
     // attachment for widget needs to go before widget declaration so the attachment is destroyed before the widget
 
     RotarySliderWithLabels 
@@ -366,6 +925,16 @@ private:
 
     std::vector<juce::Component*> getComps();
 
+    // the gradient, title banner and section labels only change with the layout, so they're drawn once into an image
+    void drawChrome(juce::Graphics& g);
+    CachedLayer chromeLayer { juce::Image::RGB };
+    juce::SharedResourcePointer<EmbeddedTypefaces> typefaces;
+
+   #if EQ_ENABLE_PROFILING
+    CpuLoadMeter cpuLoadMeter { audioProcessor.blockLoad };
+    StageProfileOverlay stageProfileOverlay { audioProcessor };
+   #endif
+
     // My layout
     // juce::Slider lowcutSlider;
     // std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> lowcutSliderAttachment;
@@ -395,6 +964,12 @@ private:
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> highcutComboAttachment;
     //juce::Label highcutComboLabel;
 
+    juce::ComboBox analyzerResolutionCombo;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> analyzerResolutionComboAttachment;
+
+    juce::ComboBox analyzerBallisticsCombo;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> analyzerBallisticsComboAttachment;
+
     RotaryLookAndFeel lnf;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EQPluginAudioProcessorEditor)
@@ -108,6 +108,10 @@ void EQPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
 
     spec.sampleRate = sampleRate;
 
+    // before prepare() so the filters size their state for a biquad once, here, instead of on the audio thread
+    makeEveryFilterBiquad(leftChain);
+    makeEveryFilterBiquad(rightChain);
+
     leftChain.prepare(spec);
     rightChain.prepare(spec);
 
@@ -119,6 +123,10 @@ void EQPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     leftChannelFifo.prepare(samplesPerBlock);
     rightChannelFifo.prepare(samplesPerBlock);
 
+   #if EQ_ENABLE_PROFILING
+    blockLoad.prepare(sampleRate);
+   #endif
+
     // osc.initialise([](float x) { return std::sin(x); }); // lambda? // sine wave noise
     // spec.numChannels = getTotalNumOutputChannels();
     // osc.prepare(spec);
@@ -190,6 +198,11 @@ bool EQPluginAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 
 void EQPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    // outermost, so the probes below get checked too
+    EQ_REALTIME_SECTION;
+    EQ_PROFILE_BLOCK(blockLoad, buffer.getNumSamples());
+    EQ_TRACE_SCOPE("audio", "processBlock");
+
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -229,7 +242,10 @@ void EQPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     // auto& rightHighCut = rightChain.get<ChainPositions::HighCut>();
     // updateCutFilter(rightHighCut, highcutCoefficients, chainSettings.highCutSlope);
 
-    updateFilters();
+    {
+        EQ_PROFILE_STAGE(stageProfiler, Stage_UpdateFilters);
+        updateFilters();
+    }
 
 
     // Chain needs a ProcessingContext to be passed to run audio through links in chain
@@ -241,19 +257,33 @@ void EQPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     // osc.process(stereoContext); // sine wave noise
 
     // Buffer can have any num of channels, so pass declare the two we have using HelperFunction
+    // a mono layout only has channel 0, that goes through the left chain and the right one sits idle
+    const bool isStereo = block.getNumChannels() > 1;
     auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+    auto rightBlock = block.getSingleChannelBlock(isStereo ? 1 : 0);
 
     // Blocks split by channel, create ProcessingContext from each block
     juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
     juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
 
     // Process the context
+   #if EQ_ENABLE_PROFILING
+    auto* rightContextToUse = isStereo ? &rightContext : nullptr;
+    processLink<ChainPositions::LowCut>(leftContext, rightContextToUse, Stage_LowCut);
+    processLink<ChainPositions::Peak>(leftContext, rightContextToUse, Stage_Peak);
+    processLink<ChainPositions::HighCut>(leftContext, rightContextToUse, Stage_HighCut);
+   #else
     leftChain.process(leftContext);
-    rightChain.process(rightContext);
 
-    leftChannelFifo.update(buffer);
-    rightChannelFifo.update(buffer);
+    if (isStereo)
+        rightChain.process(rightContext);
+   #endif
+
+    {
+        EQ_PROFILE_STAGE(stageProfiler, Stage_AnalyzerTap);
+        leftChannelFifo.update(buffer);
+        rightChannelFifo.update(buffer);
+    }
 
     // Commenting out the default below
     // After this, need to go to JUCE dir, open up the AudioPlugIn host with Projucer, make a build then build it with CMake to run it.
@@ -284,6 +314,17 @@ juce::AudioProcessorEditor* EQPluginAudioProcessor::createEditor()
     // return new juce::GenericAudioProcessorEditor(*this);
 }
 
+EQPluginAudioProcessor::MemoryReport EQPluginAudioProcessor::getMemoryReport()
+{
+    MemoryReport report;
+    report.analyzerInputFifos = leftChannelFifo.getMemoryBytes() + rightChannelFifo.getMemoryBytes();
+
+    if (auto* editor = dynamic_cast<EQPluginAudioProcessorEditor*>(getActiveEditor()))
+        report.editor = editor->getMemoryBytes();
+
+    return report;
+}
+
 //==============================================================================
 void EQPluginAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
@@ -336,9 +377,9 @@ ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts) {
     return settings;
 }
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+BiquadCoefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
 {
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, chainSettings.peakFreq, chainSettings.peakQuality, juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+    return juce::dsp::IIR::ArrayCoefficients<float>::makePeakFilter(sampleRate, chainSettings.peakFreq, chainSettings.peakQuality, juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
 }
 
 void EQPluginAudioProcessor::updatePeakFilter(const ChainSettings& chainSettings) 
@@ -387,6 +428,8 @@ void EQPluginAudioProcessor::updateHighCutFilters(const ChainSettings &chainSett
 
 void EQPluginAudioProcessor::updateFilters()
 {
+    EQ_TRACE_SCOPE("audio", "updateFilters");
+
     auto chainSettings = getChainSettings(apvts);
 
     updateLowCutFilters(chainSettings);
@@ -450,6 +493,8 @@ juce::AudioProcessorValueTreeState::ParameterLayout EQPluginAudioProcessor::crea
     params.push_back(std::make_unique<juce::AudioParameterBool>("Peak Bypassed", "Peak Bypassed", false));
     params.push_back(std::make_unique<juce::AudioParameterBool>("HighCut Bypassed", "HighCut Bypassed", false));
     params.push_back(std::make_unique<juce::AudioParameterBool>("Analyzer Enabled", "Analyzer Enabled", true));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("Analyzer Resolution", "Analyzer Resolution", juce::StringArray { "Auto", "2048", "4096", "8192", "Multi-Res" }, Resolution_Auto));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("Analyzer Ballistics", "Analyzer Ballistics", juce::StringArray { "Raw", "Average", "Peak Hold", "Decay" }, Ballistics_Average));
     
     return { params.begin(), params.end() };
 }
@@ -9,17 +9,66 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "Profiling.h"
+#include "Tracing.h"
+#include "RealtimeSafety.h"
+#include "SpectrumBallistics.h"
 
 #include <array>
+#include <atomic>
+
+// rough heap footprint of the things the FIFOs below hold, for the memory reports
+inline size_t approximateBytes(const juce::AudioBuffer<float>& buffer) { return size_t(buffer.getNumChannels()) * size_t(buffer.getNumSamples()) * sizeof(float); }
+inline size_t approximateBytes(const std::vector<float>& vector) { return vector.capacity() * sizeof(float); }
+inline size_t approximateBytes(const juce::Path& path)
+{
+    // every element is stored as a marker plus its points, lineTo (which is nearly all of them) takes 3 floats
+    size_t elements = 0;
+    for (juce::Path::Iterator it (path); it.next();)
+        ++elements;
+    return elements * 3 * sizeof(float);
+}
+
+// how a Fifo holds on to what's pushed into it:
+// queue keeps up to depth - 1 items in order, for when every item matters (audio blocks).
+// latestOnly is a triple buffer that only ever hands out the newest item, for when the reader skips to the end anyway.
+enum class FifoPolicy
+{
+    queue,
+    latestOnly
+};
+
 template<typename T>
 struct Fifo
 {
+    static constexpr int defaultDepth = 30;
+    static constexpr int maxDepth = 64;
+
+    // call before prepare(), never while anything is pushing or pulling. the slots are allocated once, up front,
+    // only the part of them in use changes, so a reader that's still holding on to one never sees it freed
+    void setPolicy(FifoPolicy newPolicy, int queueDepth = defaultDepth)
+    {
+        jassert(queueDepth >= 2 && queueDepth <= maxDepth);
+
+        policy = newPolicy;
+        depth = policy == FifoPolicy::latestOnly ? 3 : juce::jlimit(2, maxDepth, queueDepth);
+        fifo.setTotalSize(depth);
+        fifo.reset();
+
+        back = 0;
+        middle.store(1);
+        front = 2;
+    }
+
+    FifoPolicy getPolicy() const { return policy; }
+
     void prepare(int numChannels, int numSamples)
     {
         static_assert( std::is_same_v<T, juce::AudioBuffer<float>>,
                       "prepare(numChannels, numSamples) should only be used when the Fifo is holding juce::AudioBuffer<float>");
-        for( auto& buffer : buffers)
+        for( int i = 0; i < depth; ++i )
         {
+            auto& buffer = buffers[(size_t)i];
             buffer.setSize(numChannels,
                            numSamples,
                            false,   //clear everything?
@@ -33,8 +82,9 @@ struct Fifo
     {
         static_assert( std::is_same_v<T, std::vector<float>>,
                       "prepare(numElements) should only be used when the Fifo is holding std::vector<float>");
-        for( auto& buffer : buffers )
+        for( int i = 0; i < depth; ++i )
         {
+            auto& buffer = buffers[(size_t)i];
             buffer.clear();
             buffer.resize(numElements, 0);
         }
@@ -42,10 +92,18 @@ struct Fifo
     
     bool push(const T& t)
     {
+        if (policy == FifoPolicy::latestOnly)
+        {
+            // fill our private slot, then swap it into the middle and flag it as fresh
+            buffers[(size_t)back] = t;
+            back = middle.exchange(back | freshFlag) & indexMask;
+            return true;
+        }
+
         auto write = fifo.write(1);
         if( write.blockSize1 > 0 )
         {
-            buffers[write.startIndex1] = t;
+            buffers[(size_t)write.startIndex1] = t;
             return true;
         }
         
@@ -54,10 +112,21 @@ struct Fifo
     
     bool pull(T& t)
     {
+        if (policy == FifoPolicy::latestOnly)
+        {
+            if ((middle.load() & freshFlag) == 0)
+                return false;
+
+            // take the fresh middle slot, leaving our old one there as the writer's next spare
+            front = middle.exchange(front) & indexMask;
+            t = buffers[(size_t)front];
+            return true;
+        }
+
         auto read = fifo.read(1);
         if( read.blockSize1 > 0 )
         {
-            t = buffers[read.startIndex1];
+            t = buffers[(size_t)read.startIndex1];
             return true;
         }
         
@@ -66,12 +135,29 @@ struct Fifo
     
     int getNumAvailableForReading() const
     {
+        if (policy == FifoPolicy::latestOnly)
+            return (middle.load() & freshFlag) != 0 ? 1 : 0;
+
         return fifo.getNumReady();
     }
+
+    size_t getMemoryBytes() const
+    {
+        size_t bytes = 0;
+        for (const auto& buffer : buffers)
+            bytes += approximateBytes(buffer);
+        return bytes;
+    }
 private:
-    static constexpr int Capacity = 30;
-    std::array<T, Capacity> buffers;
-    juce::AbstractFifo fifo {Capacity};
+    FifoPolicy policy = FifoPolicy::queue;
+    std::array<T, maxDepth> buffers;
+    int depth = defaultDepth;   // slots in use, the first 'depth' of buffers
+    juce::AbstractFifo fifo {defaultDepth};
+
+    // latestOnly: each side owns one slot, 'middle' is the one in between plus a flag saying the writer refilled it
+    static constexpr int indexMask = 3, freshFlag = 4;
+    int back = 0, front = 2;
+    std::atomic<int> middle { 1 };
 };
 
 enum Channel
@@ -91,8 +177,10 @@ struct SingleChannelSampleFifo
     void update(const BlockType& buffer)
     {
         jassert(prepared.get());
-        jassert(buffer.getNumChannels() > channelToUse );
-        auto* channelPtr = buffer.getReadPointer(channelToUse);
+        jassert(buffer.getNumChannels() > 0);
+
+        // a mono buffer feeds both sides of the analyzer from its one channel
+        auto* channelPtr = buffer.getReadPointer(juce::jmin((int)channelToUse, buffer.getNumChannels() - 1));
         
         for( int i = 0; i < buffer.getNumSamples(); ++i )
         {
@@ -103,14 +191,23 @@ struct SingleChannelSampleFifo
     void prepare(int bufferSize)
     {
         prepared.set(false);
-        size.set(bufferSize);
+
+        // tiny host blocks are gathered into chunks of at least minChunkSamples, the analyzer doesn't care how
+        // the audio is cut up and the queue would otherwise need thousands of one sample buffers
+        const auto chunkSize = juce::jmax(bufferSize, minChunkSamples);
+        size.set(chunkSize);
         
         bufferToFill.setSize(1,             //channel
-                             bufferSize,    //num samples
+                             chunkSize,     //num samples
                              false,         //keepExistingContent
                              true,          //clear extra space
                              true);         //avoid reallocating
-        audioBufferFifo.prepare(1, bufferSize);
+
+        // the analyzer never looks further back than maxHistorySamples, so queueing more than that many samples
+        // only costs memory. small chunks get a deep queue, big ones a short one, the footprint stays about the same
+        auto depth = juce::jmin(Fifo<BlockType>::maxDepth, (maxHistorySamples + chunkSize - 1) / chunkSize + 2);
+        audioBufferFifo.setPolicy(FifoPolicy::queue, depth);
+        audioBufferFifo.prepare(1, chunkSize);
         fifoIndex = 0;
         prepared.set(true);
     }
@@ -120,6 +217,12 @@ struct SingleChannelSampleFifo
     int getSize() const { return size.get(); }
     //==============================================================================
     bool getAudioBuffer(BlockType& buf) { return audioBufferFifo.pull(buf); }
+
+    size_t getMemoryBytes() const { return approximateBytes(bufferToFill) + audioBufferFifo.getMemoryBytes(); }
+
+    // twice the biggest analyzer FFT, the deepest multi-resolution level spans that much input
+    static constexpr int maxHistorySamples = 2 * 8192;
+    static constexpr int minChunkSamples = 512;
 private:
     Channel channelToUse;
     int fifoIndex = 0;
@@ -151,6 +254,16 @@ enum Slope {
   Slope_48
 };
 
+// Choices for the "Analyzer Resolution" parameter, Auto picks the FFT order from the editor size and analyzer cost
+// Multi-Res runs small FFTs over decimated copies of the signal for finer low end resolution
+enum AnalyzerResolution {
+  Resolution_Auto,
+  Resolution_2048,
+  Resolution_4096,
+  Resolution_8192,
+  Resolution_MultiRes
+};
+
 // Extract params from audio processor value tree state, save it in nice data type (struct)
 struct ChainSettings {
   float peakFreq {0}, peakGainInDecibels{0}, peakQuality{1.f};
@@ -178,7 +291,12 @@ enum ChainPositions {
 using Coefficients = Filter::CoefficientsPtr;
 void updateCoefficients(Coefficients& old, const Coefficients& replacements);
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
+// b0, b1, b2, a0, a1, a2 of one biquad. filters are designed into these instead of new reference counted Coefficients
+// and then copied over the filter's own, which already has room for them, so updating a filter never allocates
+using BiquadCoefficients = std::array<float, 6>;
+inline void updateCoefficients(Coefficients& old, const BiquadCoefficients& replacements) { *old = replacements; }
+
+BiquadCoefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
 
 template<int Index, typename ChainType, typename CoefficientType>
 void update(ChainType& chain, const CoefficientType& coefficients)
@@ -220,14 +338,53 @@ void updateCutFilter(ChainType& chain, const CoefficientType& coefficients, cons
 // need inline keyword since this header file is included in multiple scripts and compiler will create defintion 
 // in each place and linker won't know which one to use
 
+// a Butterworth of order 2 * (slope + 1) as slope + 1 biquads, with the same sections and Qs as FilterDesign's
+// designIIR...HighOrderButterworthMethod, minus its ReferenceCountedArray. unused sections stay pass-through
+inline std::array<BiquadCoefficients, 4> makeButterworthSections(float frequency, double sampleRate, Slope slope, bool highPass)
+{
+  using ArrayCoefficients = juce::dsp::IIR::ArrayCoefficients<float>;
+
+  std::array<BiquadCoefficients, 4> sections;
+  sections.fill({ 1.f, 0.f, 0.f, 1.f, 0.f, 0.f });
+
+  const auto order = 2 * (slope + 1);
+  for (int i = 0; i < order / 2; ++i)
+  {
+    auto q = static_cast<float>(1.0 / (2.0 * std::cos((2.0 * i + 1.0) * juce::MathConstants<double>::pi / (order * 2.0))));
+    sections[(size_t)i] = highPass ? ArrayCoefficients::makeHighPass(sampleRate, frequency, q)
+                                   : ArrayCoefficients::makeLowPass(sampleRate, frequency, q);
+  }
+
+  return sections;
+}
+
 inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
 {
-  return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, sampleRate, 2 * (chainSettings.lowCutSlope + 1));
+  return makeButterworthSections(chainSettings.lowCutFreq, sampleRate, chainSettings.lowCutSlope, true);
 }
 
 inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
 {
-  return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, sampleRate, 2 * (chainSettings.highCutSlope + 1));
+  return makeButterworthSections(chainSettings.highCutFreq, sampleRate, chainSettings.highCutSlope, false);
+}
+
+// gives every filter in the chain biquad coefficients. call before prepare(), so a filter that a slope change brings
+// into use later doesn't change order, which makes IIR::Filter reallocate its state on the audio thread
+inline void makeEveryFilterBiquad(MonoChain& chain)
+{
+  const BiquadCoefficients passThrough { 1.f, 0.f, 0.f, 1.f, 0.f, 0.f };
+
+  auto makeCutFilterBiquads = [&passThrough](CutFilter& cut)
+  {
+    updateCoefficients(cut.get<0>().coefficients, passThrough);
+    updateCoefficients(cut.get<1>().coefficients, passThrough);
+    updateCoefficients(cut.get<2>().coefficients, passThrough);
+    updateCoefficients(cut.get<3>().coefficients, passThrough);
+  };
+
+  makeCutFilterBiquads(chain.get<ChainPositions::LowCut>());
+  updateCoefficients(chain.get<ChainPositions::Peak>().coefficients, passThrough);
+  makeCutFilterBiquads(chain.get<ChainPositions::HighCut>());
 }
 
 //==============================================================================
@@ -288,6 +445,24 @@ public:
     SingleChannelSampleFifo<BlockType> leftChannelFifo { Channel::Left };
     SingleChannelSampleFifo<BlockType> rightChannelFifo { Channel::Right };
 
+    // bytes this instance holds on to, to keep an eye on the footprint of big sessions. call from the message thread
+    struct MemoryReport
+    {
+        size_t analyzerInputFifos = 0;  // always allocated, whether the editor is open or not
+        size_t editor = 0;              // analyzer histories, FFT buffers, FIFOs and cached images, 0 with no editor open
+        size_t total() const { return analyzerInputFifos + editor; }
+    };
+
+    MemoryReport getMemoryReport();
+
+   #if EQ_ENABLE_PROFILING
+    // how long each processBlock took against its real-time budget, the editor's CPU meter reads it
+    BlockLoadHistogram blockLoad;
+
+    // where the time inside processBlock goes, see getTable() or click the CPU meter
+    StageProfiler stageProfiler;
+   #endif
+
 private:
 
     // Create filter type aliases to use for setting two mono chains to process in stereo
@@ -316,6 +491,38 @@ private:
 
     void updateFilters();
 
+    // writes a Chrome trace when EQ_TRACE_FILE is set, shared by every instance in the process
+    juce::SharedResourcePointer<TraceSession> traceSession;
+
+   #if EQ_ENABLE_PROFILING
+    // what leftChain.process() and rightChain.process() do, one link of both chains at a time so each link can be
+    // timed on its own. links bypassed in both chains still run, they just aren't timed
+    template<int Position>
+    void processLink(const juce::dsp::ProcessContextReplacing<float>& leftContext,
+                     const juce::dsp::ProcessContextReplacing<float>* rightContext, ProfileStage stage)
+    {
+        // ProcessorChain hands each link a copy of the context flagged with that link's bypass state, and still calls
+        // process() on a bypassed link so its filter state keeps running. a mono layout has no right context
+        auto leftLinkContext = leftContext;
+        leftLinkContext.isBypassed = leftContext.isBypassed || leftChain.isBypassed<Position>();
+        const bool rightBypassed = rightContext == nullptr || rightContext->isBypassed || rightChain.isBypassed<Position>();
+
+        const auto startCycles = readCycleCounter();
+
+        leftChain.get<Position>().process(leftLinkContext);
+
+        if (rightContext != nullptr)
+        {
+            auto rightLinkContext = *rightContext;
+            rightLinkContext.isBypassed = rightBypassed;
+            rightChain.get<Position>().process(rightLinkContext);
+        }
+
+        if (! (leftLinkContext.isBypassed && rightBypassed))
+            stageProfiler.add(stage, readCycleCounter() - startCycles);
+    }
+   #endif
+
     //juce::dsp::Oscillator<float> osc;
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EQPluginAudioProcessor)
@@ -0,0 +1,327 @@
+/*
+  ==============================================================================
+
+    Profiling.h
+    Cheap timing of the audio thread. processBlock stamps its entry and exit,
+    and the block time, as a fraction of the real-time budget the block had,
+    goes into a lock-free histogram the editor reads from. Two high resolution
+    tick reads and a few relaxed stores per block, nowhere near 1% even at a
+    block size of 1. Inside the block every stage of the chain is timed with
+    the CPU's cycle counter into per stage accumulators.
+    Build with EQ_ENABLE_PROFILING=0 to compile it all out.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+#ifndef EQ_ENABLE_PROFILING
+ #define EQ_ENABLE_PROFILING 1
+#endif
+
+// written by the audio thread only, read from anywhere. a block's load is its time over numSamples / sampleRate,
+// so 1 means it used the whole budget
+struct BlockLoadHistogram
+{
+    // equal width bins from 0 to maxLoad, the last one also catches everything slower
+    static constexpr int numBins = 128;
+    static constexpr float maxLoad = 2.f;
+
+    // call from prepareToPlay
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        ticksPerSecond = double(juce::Time::getHighResolutionTicksPerSecond());
+        reset();
+    }
+
+    // clears the counts, fine to call while the audio thread is adding
+    void reset()
+    {
+        for (auto& bin : bins)
+            bin.store(0, std::memory_order_relaxed);
+
+        numBlocks.store(0, std::memory_order_relaxed);
+        averageLoad.store(0.f, std::memory_order_relaxed);
+        peakLoad.store(0.f, std::memory_order_relaxed);
+    }
+
+    // audio thread
+    void addBlock(juce::int64 elapsedTicks, int numSamples)
+    {
+        if (numSamples <= 0 || sampleRate <= 0.0)
+            return;
+
+        auto budgetSeconds = numSamples / sampleRate;
+        auto load = float(double(elapsedTicks) / ticksPerSecond / budgetSeconds);
+
+        // there's only one writer, so plain load + store is enough and skips the locked read-modify-writes
+        auto& bin = bins[(size_t)juce::jlimit(0, numBins - 1, int(load * (float(numBins) / maxLoad)))];
+        bin.store(bin.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        numBlocks.store(numBlocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        // averaged over about half a second of audio whatever the block size
+        auto coefficient = float(juce::jmin(1.0, budgetSeconds / 0.5));
+        auto average = averageLoad.load(std::memory_order_relaxed);
+        averageLoad.store(average + coefficient * (load - average), std::memory_order_relaxed);
+
+        if (load > peakLoad.load(std::memory_order_relaxed))
+            peakLoad.store(load, std::memory_order_relaxed);
+    }
+
+    float getAverageLoad() const { return averageLoad.load(std::memory_order_relaxed); }
+
+    // highest load since the last call, meant for a single reader like the editor's meter
+    float takePeakLoad() { return peakLoad.exchange(0.f, std::memory_order_relaxed); }
+
+    std::uint64_t getNumBlocks() const { return numBlocks.load(std::memory_order_relaxed); }
+
+    // blocks that took longer than they had, the ones that drop out
+    std::uint64_t getNumOverruns() const
+    {
+        std::uint64_t overruns = 0;
+        for (int i = int(float(numBins) / maxLoad); i < numBins; ++i)
+            overruns += bins[(size_t)i].load(std::memory_order_relaxed);
+        return overruns;
+    }
+
+    // load below which 'fraction' of all blocks so far fell, to the resolution of one bin
+    float getPercentileLoad(double fraction) const
+    {
+        std::array<std::uint64_t, numBins> counts;
+        std::uint64_t total = 0;
+
+        for (size_t i = 0; i < counts.size(); ++i)
+            total += counts[i] = bins[i].load(std::memory_order_relaxed);
+
+        if (total == 0)
+            return 0.f;
+
+        auto target = std::uint64_t(std::ceil(juce::jlimit(0.0, 1.0, fraction) * double(total)));
+        std::uint64_t seen = 0;
+
+        for (size_t i = 0; i < counts.size(); ++i)
+        {
+            seen += counts[i];
+            if (seen >= target)
+                return float(i + 1) * maxLoad / float(numBins);
+        }
+
+        return maxLoad;
+    }
+
+private:
+    double sampleRate = 0.0, ticksPerSecond = 1.0;
+
+    std::array<std::atomic<std::uint64_t>, numBins> bins {};
+    std::atomic<std::uint64_t> numBlocks { 0 };
+    std::atomic<float> averageLoad { 0.f }, peakLoad { 0.f };
+};
+
+// times its own lifetime into a BlockLoadHistogram, put it at the top of processBlock
+struct ScopedBlockTimer
+{
+    ScopedBlockTimer(BlockLoadHistogram& histogramToUse, int numSamplesInBlock)
+        : histogram(histogramToUse), numSamples(numSamplesInBlock), startTicks(juce::Time::getHighResolutionTicks()) { }
+
+    ~ScopedBlockTimer() { histogram.addBlock(juce::Time::getHighResolutionTicks() - startTicks, numSamples); }
+
+    BlockLoadHistogram& histogram;
+    const int numSamples;
+    const juce::int64 startTicks;
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedBlockTimer)
+};
+
+//==============================================================================
+// a few cycles to read, unlike the OS clocks. rdtsc on x86, the virtual counter on 64 bit ARM,
+// the high resolution clock anywhere else
+inline std::uint64_t readCycleCounter() noexcept
+{
+   #if JUCE_INTEL
+    return (std::uint64_t)__rdtsc();
+   #elif JUCE_ARM && defined(__aarch64__)
+    std::uint64_t value;
+    asm volatile ("mrs %0, cntvct_el0" : "=r" (value));
+    return value;
+   #else
+    return (std::uint64_t)juce::Time::getHighResolutionTicks();
+   #endif
+}
+
+// rate of readCycleCounter(), measured against the high resolution clock the first time it's asked for.
+// that takes about 10ms, so don't ask for it first on the audio thread
+inline double getCycleCounterFrequency()
+{
+    static const double frequency = []
+    {
+        auto startTicks = juce::Time::getHighResolutionTicks();
+        auto startCycles = readCycleCounter();
+        double seconds = 0.0;
+
+        while (seconds < 0.01)
+            seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+        return double(readCycleCounter() - startCycles) / seconds;
+    }();
+
+    return frequency;
+}
+
+// the parts of processBlock that get timed on their own
+enum ProfileStage
+{
+    Stage_UpdateFilters,    // parameter reads and coefficient design
+    Stage_LowCut,
+    Stage_Peak,
+    Stage_HighCut,
+    Stage_AnalyzerTap,      // copying the block into the analyzer FIFOs
+    numProfileStages
+};
+
+inline const char* getProfileStageName(ProfileStage stage)
+{
+    switch (stage)
+    {
+        case Stage_UpdateFilters: return "updateFilters";
+        case Stage_LowCut: return "low cut";
+        case Stage_Peak: return "peak";
+        case Stage_HighCut: return "high cut";
+        case Stage_AnalyzerTap: return "analyzer tap";
+        case numProfileStages: break;
+    }
+
+    return "";
+}
+
+// cycles spent per stage, written by the audio thread only, read from anywhere
+struct StageProfiler
+{
+    // audio thread. stages that are bypassed don't get timed, so calls counts the blocks a stage actually ran in
+    void add(ProfileStage stage, std::uint64_t cycles)
+    {
+        auto& accumulator = accumulators[(size_t)stage];
+
+        // single writer, same as BlockLoadHistogram
+        accumulator.calls.store(accumulator.calls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        accumulator.cycles.store(accumulator.cycles.load(std::memory_order_relaxed) + cycles, std::memory_order_relaxed);
+
+        if (cycles > accumulator.maxCycles.load(std::memory_order_relaxed))
+            accumulator.maxCycles.store(cycles, std::memory_order_relaxed);
+    }
+
+    void reset()
+    {
+        for (auto& accumulator : accumulators)
+        {
+            accumulator.calls.store(0, std::memory_order_relaxed);
+            accumulator.cycles.store(0, std::memory_order_relaxed);
+            accumulator.maxCycles.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    struct StageStats
+    {
+        ProfileStage stage;
+        std::uint64_t calls = 0;
+        double meanMicroseconds = 0.0;
+        double maxMicroseconds = 0.0;
+        double shareOfTotal = 0.0;  // of all the time spent in timed stages, 0..1
+    };
+
+    // message thread, it allocates and may calibrate the cycle counter
+    std::vector<StageStats> getStats() const
+    {
+        const auto microsecondsPerCycle = 1.0e6 / getCycleCounterFrequency();
+
+        std::vector<StageStats> stats;
+        double totalCycles = 0.0;
+
+        for (int i = 0; i < numProfileStages; ++i)
+        {
+            const auto& accumulator = accumulators[(size_t)i];
+
+            StageStats stage;
+            stage.stage = static_cast<ProfileStage>(i);
+            stage.calls = accumulator.calls.load(std::memory_order_relaxed);
+
+            auto cycles = double(accumulator.cycles.load(std::memory_order_relaxed));
+            totalCycles += cycles;
+
+            stage.meanMicroseconds = stage.calls > 0 ? cycles * microsecondsPerCycle / double(stage.calls) : 0.0;
+            stage.maxMicroseconds = double(accumulator.maxCycles.load(std::memory_order_relaxed)) * microsecondsPerCycle;
+            stage.shareOfTotal = cycles;
+            stats.push_back(stage);
+        }
+
+        for (auto& stage : stats)
+            stage.shareOfTotal = totalCycles > 0.0 ? stage.shareOfTotal / totalCycles : 0.0;
+
+        return stats;
+    }
+
+    // getStats() as a fixed width text table, one stage per row
+    juce::String getTable() const
+    {
+        juce::String table;
+        table << juce::String("stage").paddedRight(' ', 15) << juce::String("calls").paddedLeft(' ', 10)
+              << juce::String("mean us").paddedLeft(' ', 10) << juce::String("max us").paddedLeft(' ', 10)
+              << juce::String("share").paddedLeft(' ', 8) << "\n";
+
+        for (const auto& stage : getStats())
+        {
+            table << juce::String(getProfileStageName(stage.stage)).paddedRight(' ', 15)
+                  << juce::String((juce::int64)stage.calls).paddedLeft(' ', 10)
+                  << juce::String(stage.meanMicroseconds, 2).paddedLeft(' ', 10)
+                  << juce::String(stage.maxMicroseconds, 1).paddedLeft(' ', 10)
+                  << (juce::String(stage.shareOfTotal * 100.0, 1) + "%").paddedLeft(' ', 8) << "\n";
+        }
+
+        return table;
+    }
+
+private:
+    struct Accumulator
+    {
+        std::atomic<std::uint64_t> calls { 0 }, cycles { 0 }, maxCycles { 0 };
+    };
+
+    std::array<Accumulator, numProfileStages> accumulators;
+};
+
+// times its own lifetime into one stage of a StageProfiler
+struct ScopedStageProbe
+{
+    ScopedStageProbe(StageProfiler& profilerToUse, ProfileStage stageToTime)
+        : profiler(profilerToUse), stage(stageToTime), startCycles(readCycleCounter()) { }
+
+    ~ScopedStageProbe() { profiler.add(stage, readCycleCounter() - startCycles); }
+
+    StageProfiler& profiler;
+    const ProfileStage stage;
+    const std::uint64_t startCycles;
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedStageProbe)
+};
+
+#if EQ_ENABLE_PROFILING
+ #define EQ_PROFILE_BLOCK(histogram, numSamples) const ScopedBlockTimer JUCE_JOIN_MACRO(eqBlockTimer_, __LINE__) (histogram, numSamples)
+ #define EQ_PROFILE_STAGE(profiler, stage) const ScopedStageProbe JUCE_JOIN_MACRO(eqStageProbe_, __LINE__) (profiler, stage)
+#else
+ #define EQ_PROFILE_BLOCK(histogram, numSamples)
+ #define EQ_PROFILE_STAGE(profiler, stage)
+#endif
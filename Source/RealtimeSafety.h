@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.h
+    Marks the code that runs on the audio thread so it can be checked for
+    allocations and locks. The marks don't check anything themselves: in a
+    build with EQ_REALTIME_SAFETY_CHECKS=1, Tools/RealtimeSafetyCheck.cpp
+    interposes malloc, free, operator new/delete and pthread_mutex_lock and
+    reports every call made while a thread is inside a marked section.
+    Everywhere else EQ_REALTIME_SECTION compiles to nothing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef EQ_REALTIME_SAFETY_CHECKS
+ #define EQ_REALTIME_SAFETY_CHECKS 0
+#endif
+
+struct RealtimeSection
+{
+    // how many marked sections the calling thread is inside of, the interposed functions check it on every call
+    static int& depth() noexcept
+    {
+        static thread_local int sections = 0;
+        return sections;
+    }
+
+    static bool isActive() noexcept { return depth() > 0; }
+};
+
+struct ScopedRealtimeSection
+{
+    ScopedRealtimeSection() noexcept { ++RealtimeSection::depth(); }
+    ~ScopedRealtimeSection() noexcept { --RealtimeSection::depth(); }
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedRealtimeSection)
+};
+
+#if EQ_REALTIME_SAFETY_CHECKS
+ #define EQ_REALTIME_SECTION const ScopedRealtimeSection JUCE_JOIN_MACRO(eqRealtimeSection_, __LINE__)
+#else
+ #define EQ_REALTIME_SECTION
+#endif
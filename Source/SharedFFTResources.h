@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    SharedFFTResources.h
+    FFT engines and window tables only depend on their order and window type,
+    so one of each is shared by every analyzer in the process: both channels,
+    every level of the multi-resolution analyzer, every open editor and every
+    plugin instance. Entries are reference counted and go away with their last
+    user, so nothing stays allocated once all editors are closed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+struct SharedFFTResources
+{
+    using WindowType = juce::dsp::WindowingFunction<float>::WindowingMethod;
+
+    // juce::dsp::FFT's transforms are const, so one engine can serve any number of analyzers
+    static std::shared_ptr<const juce::dsp::FFT> getFFT(int order)
+    {
+        auto& cache = getInstance();
+        const std::lock_guard<std::mutex> lock (cache.mutex);
+
+        return findOrCreate(cache.ffts, order, [order] { return std::shared_ptr<const juce::dsp::FFT>(std::make_shared<juce::dsp::FFT>(order)); });
+    }
+
+    // 'size' points of the given window, normalised the way fillWindowingTables() does by default
+    static std::shared_ptr<const std::vector<float>> getWindow(int size, WindowType type)
+    {
+        auto& cache = getInstance();
+        const std::lock_guard<std::mutex> lock (cache.mutex);
+
+        return findOrCreate(cache.windows, std::make_pair(size, type), [size, type]
+        {
+            auto table = std::make_shared<std::vector<float>>((size_t)size);
+            juce::dsp::WindowingFunction<float>::fillWindowingTables(table->data(), (size_t)size, type);
+            return std::shared_ptr<const std::vector<float>>(std::move(table));
+        });
+    }
+
+    // how many distinct engines and tables are alive right now, for memory reports
+    static int getNumLiveFFTs()    { auto& cache = getInstance(); const std::lock_guard<std::mutex> lock (cache.mutex); return countLive(cache.ffts); }
+    static int getNumLiveWindows() { auto& cache = getInstance(); const std::lock_guard<std::mutex> lock (cache.mutex); return countLive(cache.windows); }
+
+private:
+    std::mutex mutex;
+    std::map<int, std::weak_ptr<const juce::dsp::FFT>> ffts;
+    std::map<std::pair<int, WindowType>, std::weak_ptr<const std::vector<float>>> windows;
+
+    // inline function statics are one object per process, however many translation units include this
+    static SharedFFTResources& getInstance()
+    {
+        static SharedFFTResources instance;
+        return instance;
+    }
+
+    template<typename Map, typename Key, typename Factory>
+    static auto findOrCreate(Map& map, const Key& key, Factory&& create)
+    {
+        auto& entry = map[key];
+
+        if (auto existing = entry.lock())
+            return existing;
+
+        auto created = create();
+        entry = created;
+        return created;
+    }
+
+    template<typename Map>
+    static int countLive(const Map& map)
+    {
+        int live = 0;
+        for (const auto& entry : map)
+            live += entry.second.expired() ? 0 : 1;
+        return live;
+    }
+};
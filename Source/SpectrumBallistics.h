@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+    SpectrumBallistics.h
+    Smoothing applied to each analyzer spectrum before it becomes a path:
+    exponential averaging, peak hold with a timed release, or a plain dB/s fall.
+    Every step is a juce::FloatVectorOperations call over preallocated arrays,
+    so it stays SIMD on every platform and never allocates per frame.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <vector>
+
+// Choices for the "Analyzer Ballistics" parameter, how each new spectrum is smoothed before it's drawn
+enum AnalyzerBallistics {
+  Ballistics_Raw,
+  Ballistics_Average,
+  Ballistics_PeakHold,
+  Ballistics_Decay
+};
+
+struct SpectrumBallistics
+{
+    float averageTimeSeconds = 0.15f;   // time constant of the exponential average
+    float holdTimeSeconds = 1.f;        // how long a peak sticks before it starts falling
+    float releaseDbPerSecond = 24.f;    // fall rate for peak hold and decay
+
+    // allocates the per-bin state, call again whenever the number of bins changes
+    void prepare(int numBinsToUse, float negativeInfinity)
+    {
+        numBins = numBinsToUse;
+        floor = negativeInfinity;
+
+        state.resize((size_t)numBins);
+        holdTimers.resize((size_t)numBins);
+        mask.resize((size_t)numBins);
+
+        reset();
+    }
+
+    void reset()
+    {
+        std::fill(state.begin(), state.end(), floor);
+        std::fill(holdTimers.begin(), holdTimers.end(), 0.f);
+    }
+
+    void setMode(AnalyzerBallistics newMode)
+    {
+        if (newMode != mode)
+        {
+            mode = newMode;
+            reset();
+        }
+    }
+
+    AnalyzerBallistics getMode() const { return mode; }
+    int getNumBins() const { return numBins; }
+
+    size_t getMemoryBytes() const { return (state.capacity() + holdTimers.capacity() + mask.capacity()) * sizeof(float); }
+
+    // roughly how long the display keeps moving after the input drops by 'rangeDb'
+    float getSettleTimeSeconds(float rangeDb) const
+    {
+        switch (mode)
+        {
+            case Ballistics_Raw: return 0.f;
+            case Ballistics_Average: return averageTimeSeconds * std::log(rangeDb / 0.5f); // until it's within half a dB
+            case Ballistics_PeakHold: return holdTimeSeconds + rangeDb / releaseDbPerSecond;
+            case Ballistics_Decay: return rangeDb / releaseDbPerSecond;
+        }
+
+        return 0.f;
+    }
+
+    /*
+     replaces 'spectrum' (dB, one value per bin) with what should be displayed.
+     'elapsedSeconds' is how much audio went by since the last spectrum.
+     */
+    void process(float* spectrum, float elapsedSeconds)
+    {
+        using FVO = juce::FloatVectorOperations;
+
+        switch (mode)
+        {
+            case Ballistics_Raw:
+                return;
+
+            case Ballistics_Average:
+            {
+                // state += c * (in - state)
+                auto c = 1.f - std::exp(-elapsedSeconds / averageTimeSeconds);
+                FVO::multiply(state.data(), 1.f - c, numBins);
+                FVO::addWithMultiply(state.data(), spectrum, c, numBins);
+                break;
+            }
+
+            case Ballistics_Decay:
+            {
+                FVO::add(state.data(), -releaseDbPerSecond * elapsedSeconds, numBins);
+                FVO::max(state.data(), state.data(), spectrum, numBins);
+                break;
+            }
+
+            case Ballistics_PeakHold:
+            {
+                // no per-bin branches, the conditions become 0/1 masks by scaling and clipping
+                const float sharpness = 1.0e6f;
+
+                // bins whose hold ran out fall
+                FVO::add(holdTimers.data(), -elapsedSeconds, numBins);
+                FVO::multiply(mask.data(), holdTimers.data(), -sharpness, numBins);
+                FVO::clip(mask.data(), mask.data(), 0.f, 1.f, numBins);
+                FVO::subtractWithMultiply(state.data(), mask.data(), releaseDbPerSecond * elapsedSeconds, numBins);
+
+                // bins that reached or passed the held value restart their hold
+                FVO::subtract(mask.data(), spectrum, state.data(), numBins);
+                FVO::multiply(mask.data(), sharpness, numBins);
+                FVO::add(mask.data(), 1.f, numBins);
+                FVO::clip(mask.data(), mask.data(), 0.f, 1.f, numBins);
+                FVO::multiply(mask.data(), holdTimeSeconds, numBins);
+                FVO::max(holdTimers.data(), holdTimers.data(), mask.data(), numBins);
+
+                FVO::max(state.data(), state.data(), spectrum, numBins);
+                break;
+            }
+        }
+
+        FVO::copy(spectrum, state.data(), numBins);
+    }
+
+private:
+    AnalyzerBallistics mode = Ballistics_Raw;
+    int numBins = 0;
+    float floor = -48.f;
+
+    std::vector<float> state, holdTimers, mask;
+};
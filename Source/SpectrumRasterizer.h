@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    SpectrumRasterizer.h
+    Draws an analyzer spectrum, given as one y per pixel column, straight into
+    an Image::BitmapData. Every column is a single vertical span with partly
+    covered end pixels for anti-aliasing, so there's no path flattening, edge
+    table or scanline conversion like stroking a juce::Path costs.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+struct SpectrumRasterizer
+{
+    /*
+     draws the line through (column, ys[column] + yOffset) for every column of 'data', 'thickness' px tall.
+     nan ys are gaps. if 'fillColour' isn't transparent the area under the line is filled down to the bottom of 'data'.
+     */
+    static void draw(juce::Image::BitmapData& data, const float* ys, int numColumns, float yOffset, float thickness,
+                     juce::Colour lineColour, juce::Colour fillColour)
+    {
+        if (data.pixelFormat == juce::Image::ARGB)
+            drawColumns<juce::PixelARGB>(data, ys, numColumns, yOffset, thickness, lineColour, fillColour);
+        else if (data.pixelFormat == juce::Image::RGB)
+            drawColumns<juce::PixelRGB>(data, ys, numColumns, yOffset, thickness, lineColour, fillColour);
+        else
+            jassertfalse; // single channel images aren't worth supporting here
+    }
+
+private:
+    template<typename PixelType>
+    static void drawColumns(juce::Image::BitmapData& data, const float* ys, int numColumns, float yOffset, float thickness,
+                            juce::Colour lineColour, juce::Colour fillColour)
+    {
+        const auto line = lineColour.getPixelARGB();
+        const auto fill = fillColour.getPixelARGB();
+        const bool shouldFill = ! fillColour.isTransparent();
+        const auto halfThickness = thickness * 0.5f;
+        const auto height = float(data.height);
+        const auto width = juce::jmin(numColumns, data.width);
+
+        for (int x = 0; x < width; ++x)
+        {
+            const auto y = ys[x];
+            if (std::isnan(y))
+                continue;
+
+            // inside its own column the line runs from halfway to the left neighbour to halfway to the right one
+            const auto left = x > 0 && ! std::isnan(ys[x - 1]) ? 0.5f * (y + ys[x - 1]) : y;
+            const auto right = x + 1 < numColumns && ! std::isnan(ys[x + 1]) ? 0.5f * (y + ys[x + 1]) : y;
+
+            const auto top = juce::jmin(y, left, right) + yOffset - halfThickness;
+            const auto bottom = juce::jmax(y, left, right) + yOffset + halfThickness;
+
+            if (shouldFill)
+                blendSpan<PixelType>(data, x, bottom, height, fill);
+
+            blendSpan<PixelType>(data, x, top, bottom, line);
+        }
+    }
+
+    // blends 'colour' over rows [top, bottom) of column 'x', the end rows weighted by how much of them is covered
+    template<typename PixelType>
+    static void blendSpan(juce::Image::BitmapData& data, int x, float top, float bottom, juce::PixelARGB colour)
+    {
+        top = juce::jmax(top, 0.f);
+        bottom = juce::jmin(bottom, float(data.height));
+
+        if (bottom <= top)
+            return;
+
+        const auto firstRow = (int)top;
+        const auto lastRow = (int)std::ceil(bottom) - 1;
+        auto* pixel = data.getPixelPointer(x, firstRow);
+
+        for (int row = firstRow; row <= lastRow; ++row, pixel += data.lineStride)
+        {
+            const auto coverage = juce::jmin(bottom, float(row + 1)) - juce::jmax(top, float(row));
+            reinterpret_cast<PixelType*>(pixel)->blend(colour, (juce::uint32)juce::roundToInt(coverage * 255.f));
+        }
+    }
+};
@@ -0,0 +1,299 @@
+/*
+  ==============================================================================
+
+    Tracing.h
+    Timestamped scopes from the audio thread, the analyzer and painting,
+    written out as Chrome Trace Event JSON that chrome://tracing or
+    ui.perfetto.dev can open. Set EQ_TRACE_FILE to a path before starting
+    the host and every plugin instance in the process traces into that file.
+    If every instance is closed and a new one opened, the new session writes
+    to the same name with _2, _3... added rather than overwriting the first.
+    The trace ends with a metadata event counting the events it dropped.
+
+    Each thread that traces gets a ring of events out of a pool allocated
+    when tracing starts, so recording one never allocates or locks. A
+    background thread drains the rings into the file a few times a second.
+    With EQ_TRACE_FILE unset a scope costs one atomic load.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Profiling.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// tracing rides on the profiling switch unless it's set on its own
+#ifndef EQ_ENABLE_TRACING
+ #define EQ_ENABLE_TRACING EQ_ENABLE_PROFILING
+#endif
+
+// one trace file per process. owned through a SharedResourcePointer by every processor, so it opens with the first
+// instance and is finished and closed when the last one goes away
+struct TraceSession : private juce::Thread
+{
+    static constexpr int maxThreads = 16;
+    static constexpr int eventsPerThread = 1 << 15;
+
+    TraceSession() : juce::Thread("EQ trace writer")
+    {
+        auto path = juce::SystemStats::getEnvironmentVariable("EQ_TRACE_FILE", {});
+
+        if (path.isNotEmpty())
+            start(juce::File::getCurrentWorkingDirectory().getChildFile(path));
+    }
+
+    ~TraceSession() override { stop(); }
+
+    // 'category' and 'name' have to be string literals, only the pointers are kept
+    static void record(const char* category, const char* name, juce::int64 startTicks, juce::int64 endTicks)
+    {
+        if (auto* session = active().load(std::memory_order_acquire))
+        {
+            if (auto* ring = session->getRingForThisThread(category))
+                ring->push({ name, category, startTicks, endTicks });
+            else
+                session->eventsWithoutARing.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    static bool isTracing() { return active().load(std::memory_order_relaxed) != nullptr; }
+
+    // why EQ_TRACE_FILE was set and this session isn't tracing, empty otherwise
+    juce::String getLastError() const { return lastError; }
+
+    // where this session writes, which has a session number on it after the first
+    juce::File getFile() const { return file; }
+
+    // events thrown away because a ring was full or every ring was taken
+    int getNumDroppedEvents() const
+    {
+        int dropped = eventsWithoutARing.load(std::memory_order_relaxed);
+        for (auto& ring : rings)
+            if (ring != nullptr)
+                dropped += ring->dropped.load(std::memory_order_relaxed);
+        return dropped;
+    }
+
+private:
+    struct Event
+    {
+        const char* name;
+        const char* category;
+        juce::int64 startTicks, endTicks;
+    };
+
+    // one writer (the thread it belongs to), one reader (the writer thread)
+    struct Ring
+    {
+        Ring() : events((size_t)eventsPerThread) { }
+
+        void push(const Event& event)
+        {
+            auto write = written.load(std::memory_order_relaxed);
+
+            if (write - read.load(std::memory_order_acquire) >= (juce::uint64)eventsPerThread)
+            {
+                dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return;
+            }
+
+            events[(size_t)(write % (juce::uint64)eventsPerThread)] = event;
+            written.store(write + 1, std::memory_order_release);
+        }
+
+        std::vector<Event> events;
+        std::atomic<juce::uint64> written { 0 }, read { 0 };
+        std::atomic<int> dropped { 0 };
+        std::atomic<const char*> threadLabel { nullptr };
+        bool named = false;
+    };
+
+    static std::atomic<TraceSession*>& active()
+    {
+        static std::atomic<TraceSession*> session { nullptr };
+        return session;
+    }
+
+    // bumped by every session that starts, a new one can end up at the address of the last one
+    static std::atomic<int>& sessionCount()
+    {
+        static std::atomic<int> count { 0 };
+        return count;
+    }
+
+    Ring* getRingForThisThread(const char* category)
+    {
+        // sessions come and go with the processors, so the cached ring is only good for the session that handed it out
+        thread_local int ringSession = 0;
+        thread_local Ring* ring = nullptr;
+
+        if (ringSession != sessionNumber)
+        {
+            ringSession = sessionNumber;
+            auto index = nextRing.fetch_add(1, std::memory_order_relaxed);
+            ring = index < maxThreads ? rings[(size_t)index].get() : nullptr;
+
+            // the analyzer and painting share the message thread, anything else is named after what it traced first
+            if (ring != nullptr)
+                ring->threadLabel.store(juce::MessageManager::existsAndIsCurrentThread() ? "message" : category, std::memory_order_release);
+        }
+
+        return ring;
+    }
+
+    void start(const juce::File& requestedFile)
+    {
+        // a later session in the same process gets its own file, the earlier trace is still wanted
+        sessionNumber = ++sessionCount();
+        file = sessionNumber == 1 ? requestedFile
+                                  : requestedFile.getSiblingFile(requestedFile.getFileNameWithoutExtension() + "_" + juce::String(sessionNumber)
+                                                                 + requestedFile.getFileExtension());
+        file.deleteFile();
+        output = file.createOutputStream();
+
+        if (output == nullptr)
+        {
+            lastError = "can't write the trace to " + file.getFullPathName();
+            return;
+        }
+
+        for (auto& ring : rings)
+            ring = std::make_unique<Ring>();
+
+        startTicks = juce::Time::getHighResolutionTicks();
+        *output << "[\n";
+
+        // only one session traces at a time, the first one to open a file wins
+        TraceSession* expected = nullptr;
+        if (active().compare_exchange_strong(expected, this))
+        {
+            startThread();
+        }
+        else
+        {
+            output = nullptr;
+            file.deleteFile();
+            lastError = "another session is already tracing";
+        }
+    }
+
+    void stop()
+    {
+        if (output == nullptr)
+            return;
+
+        TraceSession* expected = this;
+        active().compare_exchange_strong(expected, nullptr);
+
+        stopThread(1000);
+        flush();
+
+        // in the file rather than on the console, so a trace that's missing events says so wherever it's opened
+        writeSeparator();
+        *output << "{\"name\":\"trace_stats\",\"ph\":\"M\",\"pid\":1,\"args\":{\"dropped_events\":" << getNumDroppedEvents() << "}}";
+
+        *output << "\n]\n";
+        output->flush();
+        output = nullptr;
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            wait(100);
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        const auto pid = 1;
+        auto numRings = juce::jmin(maxThreads, nextRing.load(std::memory_order_acquire));
+
+        for (int tid = 0; tid < numRings; ++tid)
+        {
+            auto& ring = *rings[(size_t)tid];
+
+            if (! ring.named)
+            {
+                if (auto* label = ring.threadLabel.load(std::memory_order_acquire))
+                {
+                    writeSeparator();
+                    *output << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << tid
+                            << ",\"args\":{\"name\":\"" << label << " thread\"}}";
+                    ring.named = true;
+                }
+            }
+
+            auto read = ring.read.load(std::memory_order_relaxed);
+            auto written = ring.written.load(std::memory_order_acquire);
+
+            for (; read < written; ++read)
+            {
+                const auto& event = ring.events[(size_t)(read % (juce::uint64)eventsPerThread)];
+
+                writeSeparator();
+                *output << "{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category << "\",\"ph\":\"X\",\"ts\":"
+                        << juce::String(ticksToMicroseconds(event.startTicks - startTicks), 3)
+                        << ",\"dur\":" << juce::String(ticksToMicroseconds(event.endTicks - event.startTicks), 3)
+                        << ",\"pid\":" << pid << ",\"tid\":" << tid << "}";
+            }
+
+            ring.read.store(read, std::memory_order_release);
+        }
+
+        output->flush();
+    }
+
+    void writeSeparator()
+    {
+        if (wroteAnEvent)
+            *output << ",\n";
+
+        wroteAnEvent = true;
+    }
+
+    static double ticksToMicroseconds(juce::int64 ticks) { return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6; }
+
+    juce::File file;
+    juce::String lastError;
+    std::unique_ptr<juce::FileOutputStream> output;
+    std::array<std::unique_ptr<Ring>, maxThreads> rings;
+    std::atomic<int> nextRing { 0 };
+    std::atomic<int> eventsWithoutARing { 0 };  // from threads that came after every ring was taken
+    juce::int64 startTicks = 0;
+    int sessionNumber = 0;
+    bool wroteAnEvent = false;
+};
+
+// records its own lifetime as one trace event, nothing at all when no trace is running
+struct ScopedTrace
+{
+    ScopedTrace(const char* categoryToUse, const char* nameToUse)
+        : category(categoryToUse), name(nameToUse), startTicks(TraceSession::isTracing() ? juce::Time::getHighResolutionTicks() : 0) { }
+
+    ~ScopedTrace()
+    {
+        if (startTicks != 0)
+            TraceSession::record(category, name, startTicks, juce::Time::getHighResolutionTicks());
+    }
+
+    const char* category;
+    const char* name;
+    const juce::int64 startTicks;
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedTrace)
+};
+
+#if EQ_ENABLE_TRACING
+ #define EQ_TRACE_SCOPE(category, name) const ScopedTrace JUCE_JOIN_MACRO(eqTrace_, __LINE__) (category, name)
+#else
+ #define EQ_TRACE_SCOPE(category, name)
+#endif
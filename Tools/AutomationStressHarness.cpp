@@ -0,0 +1,258 @@
+/*
+  ==============================================================================
+
+    AutomationStressHarness.cpp
+    Looks for rare slow blocks, not the average. It drives
+    EQPluginAudioProcessor::processBlock through millions of small blocks
+    while the parameters are automated the nastiest ways a host can: random
+    automation, every parameter at once, slopes switching between 12 and
+    48 dB/oct every block, bypasses toggling, and all of that together with
+    frequencies jumping between the ends of their ranges. Each block's time
+    is recorded, and every scenario and block size gets a max and a p99.99.
+
+    A block's load is its time over the real-time budget it had,
+    numSamples / sampleRate. The harness exits with 1 if the gated statistic
+    goes over --deadline in any case.
+
+    usage: AutomationStressHarness [--blocks N] [--sample-rate Hz]
+                                   [--deadline fraction] [--gate max|p99.99]
+                                   [--seed N]
+
+    defaults: 1000000 blocks per case, 48000 Hz, deadline 0.5, gate max
+
+    The worst single block includes whatever the OS did to the thread at
+    that moment. Run it on a quiet machine, and use --gate p99.99 where that
+    noise gets in the way.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "../Benchmarks/BenchmarkUtils.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+
+namespace
+{
+    struct Options
+    {
+        int blocksPerCase = 1000000;
+        double sampleRate = 48000.0;
+        double deadline = 0.5;
+        bool gateOnPercentile = false;
+        juce::int64 seed = 1;
+    };
+
+    bool parseOptions(int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const juce::String argument (argv[i]);
+            const juce::String value (i + 1 < argc ? argv[i + 1] : "");
+
+            if (argument == "--blocks")            options.blocksPerCase = juce::jmax(1, value.getIntValue());
+            else if (argument == "--sample-rate")  options.sampleRate = juce::jmax(1000.0, value.getDoubleValue());
+            else if (argument == "--deadline")     options.deadline = value.getDoubleValue();
+            else if (argument == "--seed")         options.seed = value.getLargeIntValue();
+            else if (argument == "--gate")
+            {
+                if (value != "max" && value != "p99.99")
+                    return false;
+
+                options.gateOnPercentile = value == "p99.99";
+            }
+            else
+            {
+                return false;
+            }
+
+            ++i;
+        }
+
+        return options.deadline > 0.0;
+    }
+
+    struct Automation
+    {
+        Automation(EQPluginAudioProcessor& processorToUse, juce::int64 seed)
+            : processor(processorToUse), random(seed)
+        {
+            for (auto* parameter : processor.getParameters())
+                if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+                    parameters.add(ranged);
+        }
+
+        void set(const juce::String& parameterID, float value)
+        {
+            auto* parameter = processor.apvts.getParameter(parameterID);
+            jassert(parameter != nullptr);
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+        }
+
+        void setNormalised(juce::RangedAudioParameter& parameter, float value) { parameter.setValueNotifyingHost(value); }
+
+        EQPluginAudioProcessor& processor;
+        juce::Random random;
+        juce::Array<juce::RangedAudioParameter*> parameters;
+    };
+
+    struct Scenario
+    {
+        const char* name;
+        std::function<void(Automation&, int block)> automate;
+    };
+
+    const Scenario scenarios[] =
+    {
+        // one parameter to a random value per block, roughly what a busy automation lane looks like
+        { "random", [](Automation& automation, int)
+            {
+                auto& parameter = *automation.parameters[automation.random.nextInt(automation.parameters.size())];
+                automation.setNormalised(parameter, automation.random.nextFloat());
+            } },
+
+        // every parameter to a random value every block
+        { "all parameters", [](Automation& automation, int)
+            {
+                for (auto* parameter : automation.parameters)
+                    automation.setNormalised(*parameter, automation.random.nextFloat());
+            } },
+
+        // both cuts flip between 12 and 48 dB/oct every block, so the number of active sections keeps changing
+        { "slope switching", [](Automation& automation, int block)
+            {
+                auto slope = (block & 1) == 0 ? 0.f : 3.f;
+                automation.set("LowCut Slope", slope);
+                automation.set("HighCut Slope", 3.f - slope);
+            } },
+
+        // stages bypassed and brought back every block, each one on its own rhythm
+        { "bypass toggling", [](Automation& automation, int block)
+            {
+                automation.set("LowCut Bypassed", float(block & 1));
+                automation.set("Peak Bypassed", float((block >> 1) & 1));
+                automation.set("HighCut Bypassed", float((block >> 2) & 1));
+            } },
+
+        // everything at once, nothing bypassed, frequencies jumping between the ends of the range where the
+        // coefficients are worst conditioned, the sharpest peak and the steepest slopes switching
+        { "worst case", [](Automation& automation, int block)
+            {
+                const bool odd = (block & 1) != 0;
+                automation.set("LowCut Bypassed", 0.f);
+                automation.set("Peak Bypassed", 0.f);
+                automation.set("HighCut Bypassed", 0.f);
+                automation.set("LowCut Freq", odd ? 20.f : 20000.f);
+                automation.set("HighCut Freq", odd ? 20000.f : 20.f);
+                automation.set("Peak Freq", odd ? 20.f : 20000.f);
+                automation.set("Peak Gain", odd ? 24.f : -24.f);
+                automation.set("Peak Quality", odd ? 10.f : 0.1f);
+                automation.set("LowCut Slope", odd ? 3.f : 0.f);
+                automation.set("HighCut Slope", odd ? 0.f : 3.f);
+            } },
+    };
+
+    struct CaseResult
+    {
+        double maxLoad = 0.0, percentileLoad = 0.0, maxUs = 0.0, percentileUs = 0.0;
+        int overDeadline = 0;
+    };
+
+    const int blockSizes[] = { 1, 2, 4, 8, 16, 32, 64 };
+
+    CaseResult runCase(const Scenario& scenario, int blockSize, const Options& options)
+    {
+        EQPluginAudioProcessor processor;
+        processor.setRateAndBufferSizeDetails(options.sampleRate, blockSize);
+        processor.prepareToPlay(options.sampleRate, blockSize);
+
+        Automation automation (processor, options.seed + blockSize);
+
+        juce::AudioBuffer<float> buffer (2, blockSize);
+        juce::MidiBuffer midi;
+
+        const auto budgetSeconds = blockSize / options.sampleRate;
+        const auto warmUpBlocks = juce::jmin(10000, options.blocksPerCase / 10);
+
+        // floats so a few million blocks stay a few MB, resolution is nowhere near an issue
+        std::vector<float> blockSeconds;
+        blockSeconds.reserve((size_t)options.blocksPerCase);
+
+        CaseResult result;
+
+        for (int i = -warmUpBlocks; i < options.blocksPerCase; ++i)
+        {
+            scenario.automate(automation, i);
+
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                for (int n = 0; n < blockSize; ++n)
+                    buffer.setSample(ch, n, automation.random.nextFloat() * 0.5f - 0.25f);
+
+            auto start = juce::Time::getHighResolutionTicks();
+            processor.processBlock(buffer, midi);
+            auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+            if (i < 0)
+                continue;
+
+            blockSeconds.push_back(float(seconds));
+
+            if (seconds / budgetSeconds > options.deadline)
+                ++result.overDeadline;
+        }
+
+        // p99.99, a handful of blocks per million are allowed above it
+        Distribution<float> blocks (std::move(blockSeconds));
+        const auto percentileSeconds = blocks.getPercentile(0.9999);
+        const auto maxSeconds = blocks.getMax();
+
+        result.maxUs = maxSeconds * 1.0e6;
+        result.percentileUs = percentileSeconds * 1.0e6;
+        result.maxLoad = maxSeconds / budgetSeconds;
+        result.percentileLoad = percentileSeconds / budgetSeconds;
+        return result;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (! parseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "usage: AutomationStressHarness [--blocks N] [--sample-rate Hz] [--deadline fraction] [--gate max|p99.99] [--seed N]\n");
+        return 2;
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    std::printf("%d blocks per case at %.0f Hz, deadline %.2f of the block budget on the %s\n\n",
+                options.blocksPerCase, options.sampleRate, options.deadline, options.gateOnPercentile ? "p99.99" : "max");
+    std::printf("%-16s %6s %12s %12s %10s %10s %10s\n", "scenario", "block", "p99.99 us", "max us", "p99.99", "max", "over");
+
+    int failures = 0;
+
+    for (const auto& scenario : scenarios)
+    {
+        for (auto blockSize : blockSizes)
+        {
+            auto result = runCase(scenario, blockSize, options);
+            auto gated = options.gateOnPercentile ? result.percentileLoad : result.maxLoad;
+            const bool failed = gated > options.deadline;
+            failures += failed ? 1 : 0;
+
+            std::printf("%-16s %6d %12.2f %12.2f %10.3f %10.3f %10d%s\n", scenario.name, blockSize,
+                        result.percentileUs, result.maxUs, result.percentileLoad, result.maxLoad, result.overDeadline,
+                        failed ? "  FAIL" : "");
+            std::fflush(stdout);
+        }
+    }
+
+    std::printf("\n%s, %d of %d cases over the deadline\n", failures == 0 ? "passed" : "FAILED", failures,
+                int(std::size(scenarios) * std::size(blockSizes)));
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,675 @@
+/*
+  ==============================================================================
+
+    EQBatchRender.cpp
+    Renders many files through the EQ at once, one EQPluginAudioProcessor per
+    worker thread and every core busy. It takes the same settings as EQRender,
+    a saved state and inline parameter values, and applies them to every file.
+
+    Each file is a job. A file longer than --split-seconds, or with more than
+    two channels, becomes one job per channel instead, so a single long stem
+    can't leave the other cores idle at the end of a run. The channel jobs
+    write float parts next to the output, and whichever finishes last
+    interleaves them into the final file. The jobs go out longest first,
+    dealt round robin into a queue per worker. A worker takes from the front
+    of its own queue, and once that's empty it steals from the back of
+    another's.
+
+    Every worker reads ahead of itself and writes behind itself, each on its
+    own background thread with a bounded buffer, so decoding and disk I/O
+    overlap the processing without memory growing with the file length.
+
+    A job always starts from a freshly prepared processor, and the channels
+    of the EQ don't interact. The output is therefore bit-identical whatever
+    the thread count, the split and the order the jobs ran in. --threads 1
+    renders a reference to compare with.
+
+    usage: EQBatchRender [options] input...
+
+      inputs are audio files, or directories to search for them. under
+      --out-dir the outputs keep each file's path from the directory it was
+      found in, that directory's name included, so stems with the same name
+      in different song folders stay apart. files already ending in the
+      suffix are left out of a search. two inputs that would still render to
+      the same file fail before anything starts
+
+      --threads N           workers, one per core by default
+      --split-seconds s     split files longer than this by channel, 120 by
+                            default, 0 never splits mono or stereo files
+      --read-ahead n        samples buffered ahead of each worker, 65536
+      --write-behind n      samples buffered behind each worker, 65536
+      --state, --set, --out-dir, --suffix, --chunk   as for EQRender
+
+    Prints each file's throughput as it finishes, then the aggregate, and
+    exits with 1 if any file failed.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "OfflineRender.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <set>
+
+namespace
+{
+    struct Input
+    {
+        juce::File file, root;  // the output mirrors the file's path from root under --out-dir
+    };
+
+    struct Options
+    {
+        RenderSettings render;
+        juce::File outputDirectory;
+        juce::String suffix = "_eq";
+        juce::Array<juce::File> paths;  // as given, directories not searched yet
+        std::vector<Input> inputs;
+        int numThreads = juce::SystemStats::getNumCpus();
+        double splitSeconds = 120.0;
+        int readAheadSamples = 1 << 16, writeBehindSamples = 1 << 16;
+    };
+
+    bool parseOptions(int argc, char* argv[], Options& options)
+    {
+        const auto cwd = juce::File::getCurrentWorkingDirectory();
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const juce::String argument (argv[i]);
+
+            if (! argument.startsWith("--"))
+            {
+                options.paths.add(cwd.getChildFile(argument));
+                continue;
+            }
+
+            if (i + 1 >= argc)
+                return false;
+
+            const juce::String value (argv[++i]);
+
+            if (argument == "--state")                  options.render.stateFile = cwd.getChildFile(value);
+            else if (argument == "--out-dir")           options.outputDirectory = cwd.getChildFile(value);
+            else if (argument == "--suffix")            options.suffix = value;
+            else if (argument == "--chunk")             options.render.chunkSize = juce::jlimit(1, 1 << 20, value.getIntValue());
+            else if (argument == "--threads")           options.numThreads = juce::jmax(1, value.getIntValue());
+            else if (argument == "--split-seconds")     options.splitSeconds = juce::jmax(0.0, value.getDoubleValue());
+            else if (argument == "--read-ahead")        options.readAheadSamples = juce::jmax(1024, value.getIntValue());
+            else if (argument == "--write-behind")      options.writeBehindSamples = juce::jmax(1024, value.getIntValue());
+            else if (argument == "--set")
+            {
+                std::pair<juce::String, juce::String> parameterOverride;
+                if (! parseOverride(value, parameterOverride))
+                    return false;
+
+                options.render.overrides.push_back(parameterOverride);
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return ! options.paths.isEmpty();
+    }
+
+    // searched after parsing, so --suffix is known wherever it was on the command line. the outputs of an earlier
+    // run without --out-dir aren't inputs, nor are the hidden part files of one that was interrupted
+    void findInputs(Options& options, const juce::String& audioWildcard)
+    {
+        for (const auto& path : options.paths)
+        {
+            if (! path.isDirectory())
+            {
+                options.inputs.push_back({ path, path.getParentDirectory() });
+                continue;
+            }
+
+            for (const auto& entry : juce::RangedDirectoryIterator(path, true, audioWildcard, juce::File::findFiles | juce::File::ignoreHiddenFiles))
+            {
+                auto file = entry.getFile();
+                if (options.suffix.isEmpty() || ! file.getFileNameWithoutExtension().endsWith(options.suffix))
+                    options.inputs.push_back({ file, path.getParentDirectory() });
+            }
+        }
+    }
+
+    juce::File getOutputFileFor(const Input& input, const Options& options)
+    {
+        if (options.outputDirectory == juce::File() || input.file.getParentDirectory() == input.root)
+            return getOutputFile(input.file, options.outputDirectory, options.suffix);
+
+        auto directory = options.outputDirectory.getChildFile(input.file.getParentDirectory().getRelativePathFrom(input.root));
+        return getOutputFile(input.file, directory, options.suffix);
+    }
+
+    //==============================================================================
+    // one input file, shared by the jobs it was split into
+    struct FileJob
+    {
+        juce::File input, output;
+        int numChannels = 0;
+        juce::int64 lengthInSamples = 0;
+        double sampleRate = 0.0;
+
+        int numParts = 1;
+        std::atomic<int> partsLeft { 1 };
+        std::atomic<bool> failed { false };
+        std::atomic<double> renderSeconds { 0.0 };  // summed over the parts, the time one core spent on the file
+
+        juce::CriticalSection errorLock;
+        juce::String error;
+
+        double getAudioSeconds() const { return double(lengthInSamples) / sampleRate; }
+
+        juce::File getPartFile(int channel) const
+        {
+            return output.getSiblingFile("." + output.getFileNameWithoutExtension() + ".ch" + juce::String(channel) + ".part.wav");
+        }
+
+        void fail(const juce::String& message)
+        {
+            const juce::ScopedLock sl (errorLock);
+            if (! failed.exchange(true))
+                error = message;
+        }
+
+        void addRenderSeconds(double seconds)
+        {
+            auto current = renderSeconds.load();
+            while (! renderSeconds.compare_exchange_weak(current, current + seconds)) { }
+        }
+    };
+
+    // a whole file, or one channel of one
+    struct Job
+    {
+        std::shared_ptr<FileJob> file;
+        int firstChannel = 0, numChannels = 0;
+        bool isPart = false;
+
+        juce::int64 getCost() const { return file->lengthInSamples * numChannels; }
+    };
+
+    // a deque per worker. the jobs are whole files or channels, seconds of work each, so a lock per deque costs nothing
+    // that shows, and it keeps the stealing obviously correct
+    struct WorkStealingQueue
+    {
+        explicit WorkStealingQueue(int numWorkers) : queues((size_t)numWorkers) { }
+
+        // biggest first, so the small jobs fill in the gaps at the end
+        void deal(std::vector<Job> jobs)
+        {
+            std::stable_sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) { return a.getCost() > b.getCost(); });
+
+            for (size_t i = 0; i < jobs.size(); ++i)
+                queues[i % queues.size()].jobs.push_back(std::move(jobs[i]));
+        }
+
+        // nothing is added once the workers start, so empty everywhere means done
+        std::optional<Job> pop(int worker)
+        {
+            auto& own = queues[(size_t)worker];
+            {
+                const juce::ScopedLock sl (own.lock);
+                if (! own.jobs.empty())
+                {
+                    auto job = std::move(own.jobs.front());
+                    own.jobs.pop_front();
+                    return job;
+                }
+            }
+
+            for (size_t i = 1; i < queues.size(); ++i)
+            {
+                auto& victim = queues[((size_t)worker + i) % queues.size()];
+                const juce::ScopedLock sl (victim.lock);
+
+                if (! victim.jobs.empty())
+                {
+                    auto job = std::move(victim.jobs.back());
+                    victim.jobs.pop_back();
+                    steals.fetch_add(1, std::memory_order_relaxed);
+                    return job;
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        std::atomic<int> steals { 0 };
+
+    private:
+        struct Deque
+        {
+            juce::CriticalSection lock;
+            std::deque<Job> jobs;
+        };
+
+        std::vector<Deque> queues;
+    };
+
+    // writes on a TimeSliceThread behind the caller, like AudioFormatWriter::ThreadedWriter, but a failed write is kept
+    // rather than ignored, so a full disk fails the file instead of leaving it short and reported as rendered
+    struct WriteBehind : juce::TimeSliceClient
+    {
+        WriteBehind(std::unique_ptr<juce::AudioFormatWriter> writerToUse, juce::TimeSliceThread& threadToUse, int numSamples)
+            : writer(std::move(writerToUse)), thread(threadToUse), fifo(numSamples + 1), buffer((int)writer->numChannels, numSamples + 1)
+        {
+            thread.addTimeSliceClient(this);
+        }
+
+        ~WriteBehind() override
+        {
+            thread.removeTimeSliceClient(this);
+        }
+
+        // waits for room rather than dropping anything. false once a write has failed
+        bool write(const juce::AudioBuffer<float>& chunk)
+        {
+            const auto numSamples = chunk.getNumSamples();
+            jassert(numSamples < fifo.getTotalSize());
+
+            while (! failed.load() && fifo.getFreeSpace() < numSamples)
+                juce::Thread::sleep(1);
+
+            if (failed.load())
+                return false;
+
+            {
+                const auto scope = fifo.write(numSamples);
+                for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                {
+                    buffer.copyFrom(ch, scope.startIndex1, chunk, ch, 0, scope.blockSize1);
+                    buffer.copyFrom(ch, scope.startIndex2, chunk, ch, scope.blockSize1, scope.blockSize2);
+                }
+            }
+
+            thread.notify();
+            return true;
+        }
+
+        // waits for everything queued to reach the writer, then flushes it. false if any of it didn't make it
+        bool finish()
+        {
+            while (! failed.load() && fifo.getNumReady() > 0)
+            {
+                thread.notify();
+                juce::Thread::sleep(1);
+            }
+
+            thread.removeTimeSliceClient(this);
+            return ! failed.load() && writer->flush();
+        }
+
+        int useTimeSlice() override
+        {
+            if (failed.load() || fifo.getNumReady() == 0)
+                return 10;
+
+            const auto scope = fifo.read(fifo.getNumReady());
+            const bool ok = (scope.blockSize1 == 0 || writer->writeFromAudioSampleBuffer(buffer, scope.startIndex1, scope.blockSize1))
+                         && (scope.blockSize2 == 0 || writer->writeFromAudioSampleBuffer(buffer, scope.startIndex2, scope.blockSize2));
+
+            if (! ok)
+                failed = true;
+
+            return 0;
+        }
+
+    private:
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+        juce::TimeSliceThread& thread;
+        juce::AbstractFifo fifo;
+        juce::AudioBuffer<float> buffer;
+        std::atomic<bool> failed { false };
+    };
+
+    //==============================================================================
+    struct Batch
+    {
+        const Options& options;
+        WorkStealingQueue queue;
+        juce::CriticalSection printLock;
+        std::atomic<int> failures { 0 };
+
+        Batch(const Options& optionsToUse) : options(optionsToUse), queue(optionsToUse.numThreads) { }
+
+        void fileFinished(FileJob& file)
+        {
+            const juce::ScopedLock sl (printLock);
+
+            if (file.failed.load())
+            {
+                ++failures;
+                std::fprintf(stderr, "%s: %s\n", file.input.getFileName().toRawUTF8(), file.error.toRawUTF8());
+                return;
+            }
+
+            auto seconds = file.renderSeconds.load();
+            std::printf("%s -> %s  %.1f s of audio, %.1fx realtime%s\n", file.input.getFileName().toRawUTF8(),
+                        file.output.getFileName().toRawUTF8(), file.getAudioSeconds(),
+                        seconds > 0.0 ? file.getAudioSeconds() / seconds : 0.0,
+                        file.numParts > 1 ? (", " + juce::String(file.numParts) + " channel jobs").toRawUTF8() : "");
+            std::fflush(stdout);
+        }
+    };
+
+    struct Worker : juce::Thread
+    {
+        Worker(Batch& batchToUse, int indexToUse)
+            : juce::Thread("EQ batch worker " + juce::String(indexToUse)), batch(batchToUse), index(indexToUse)
+        {
+            formats.registerBasicFormats();
+        }
+
+        ~Worker() override
+        {
+            stopThread(-1);
+        }
+
+        void run() override
+        {
+            readThread.startThread();
+            writeThread.startThread();
+
+            while (auto job = batch.queue.pop(index))
+                runJob(*job);
+
+            readThread.stopThread(1000);
+            writeThread.stopThread(1000);
+        }
+
+    private:
+        void runJob(const Job& job)
+        {
+            auto& file = *job.file;
+
+            if (! file.failed.load())
+            {
+                auto start = juce::Time::getHighResolutionTicks();
+                auto result = render(job);
+                file.addRenderSeconds(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start));
+
+                if (result.failed())
+                    file.fail(result.getErrorMessage());
+            }
+
+            // the last part of a split file to finish puts the parts together
+            if (file.partsLeft.fetch_sub(1) != 1)
+                return;
+
+            if (file.numParts > 1)
+            {
+                if (! file.failed.load())
+                {
+                    auto start = juce::Time::getHighResolutionTicks();
+                    auto result = mergeParts(file);
+                    file.addRenderSeconds(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start));
+
+                    if (result.failed())
+                        file.fail(result.getErrorMessage());
+                }
+
+                for (int ch = 0; ch < file.numChannels; ++ch)
+                    file.getPartFile(ch).deleteFile();
+            }
+
+            batch.fileFinished(file);
+        }
+
+        juce::Result render(const Job& job)
+        {
+            auto& file = *job.file;
+            const auto chunkSize = batch.options.render.chunkSize;
+
+            auto* sourceReader = formats.createReaderFor(file.input);
+            if (sourceReader == nullptr)
+                return juce::Result::fail("can't read it as audio");
+
+            // the buffering reader owns the source, and reads ahead of us on readThread. it has to wait for the
+            // data rather than hand back silence, or the output would depend on timing
+            juce::BufferingAudioReader reader (sourceReader, readThread, batch.options.readAheadSamples);
+            reader.setReadTimeout(-1);
+
+            auto result = prepareForRender(processor, job.numChannels, file.sampleRate, chunkSize);
+            if (result.wasOk())
+                result = applySettings(processor, batch.options.render);
+            if (result.failed())
+                return result;
+
+            // resets every filter, so nothing carries over from the last job this worker ran
+            processor.prepareToPlay(file.sampleRate, chunkSize);
+
+            std::unique_ptr<juce::AudioFormatWriter> writer;
+
+            if (job.isPart)
+            {
+                // lossless float parts, the final bit depth is applied once, in mergeParts
+                auto part = file.getPartFile(job.firstChannel);
+                part.deleteFile();
+
+                if (auto stream = part.createOutputStream())
+                {
+                    writer.reset(juce::WavAudioFormat().createWriterFor(stream.get(), file.sampleRate, 1, 32, {}, 0));
+                    if (writer != nullptr)
+                        stream.release();
+                }
+            }
+            else
+            {
+                writer = createWriterFor(formats, file.output, *sourceReader, job.numChannels);
+            }
+
+            if (writer == nullptr)
+                return juce::Result::fail("can't write the output");
+
+            WriteBehind writeBehind (std::move(writer), writeThread, batch.options.writeBehindSamples);
+
+            result = renderStream(processor, reader, job.firstChannel, job.numChannels, chunkSize,
+                                  [&writeBehind](const juce::AudioBuffer<float>& chunk) { return writeBehind.write(chunk); });
+
+            if (! writeBehind.finish() && result.wasOk())
+                return juce::Result::fail("write failed, the output is incomplete");
+
+            return result;
+        }
+
+        juce::Result mergeParts(FileJob& file)
+        {
+            std::unique_ptr<juce::AudioFormatReader> source (formats.createReaderFor(file.input));
+            if (source == nullptr)
+                return juce::Result::fail("can't read it as audio");
+
+            juce::OwnedArray<juce::AudioFormatReader> parts;
+            for (int ch = 0; ch < file.numChannels; ++ch)
+            {
+                auto* part = formats.createReaderFor(file.getPartFile(ch));
+                if (part == nullptr)
+                    return juce::Result::fail("channel " + juce::String(ch) + " went missing");
+
+                parts.add(part);
+            }
+
+            auto writer = createWriterFor(formats, file.output, *source, file.numChannels);
+            if (writer == nullptr)
+                return juce::Result::fail("can't write the output");
+
+            const auto chunkSize = batch.options.render.chunkSize;
+            juce::AudioBuffer<float> chunk (file.numChannels, chunkSize), part (1, chunkSize);
+
+            for (juce::int64 position = 0; position < file.lengthInSamples; position += chunkSize)
+            {
+                const auto numSamples = (int)juce::jmin((juce::int64)chunkSize, file.lengthInSamples - position);
+                chunk.setSize(file.numChannels, numSamples, false, false, true);
+
+                for (int ch = 0; ch < file.numChannels; ++ch)
+                {
+                    if (! parts[ch]->read(&part, 0, numSamples, position, true, false))
+                        return juce::Result::fail("read failed on channel " + juce::String(ch));
+
+                    chunk.copyFrom(ch, 0, part, 0, 0, numSamples);
+                }
+
+                if (! writer->writeFromAudioSampleBuffer(chunk, 0, numSamples))
+                    return juce::Result::fail("write failed at sample " + juce::String(position));
+            }
+
+            return juce::Result::ok();
+        }
+
+        Batch& batch;
+        const int index;
+
+        juce::AudioFormatManager formats;
+        EQPluginAudioProcessor processor;
+        juce::TimeSliceThread readThread { "EQ batch read-ahead" }, writeThread { "EQ batch write-behind" };
+    };
+
+    //==============================================================================
+    std::vector<Job> makeJobs(const Options& options, juce::AudioFormatManager& formats, int& failures)
+    {
+        std::vector<Job> jobs;
+
+        // two jobs writing the same file would both report success over a corrupt output, so every output has to be
+        // unique and mustn't be any of the inputs
+        auto getKey = [](const juce::File& f)
+        {
+            auto path = f.getFullPathName();
+            return juce::File::areFileNamesCaseSensitive() ? path : path.toLowerCase();
+        };
+
+        std::set<juce::String> inputPaths, seenInputs, outputPaths;
+        for (const auto& input : options.inputs)
+            inputPaths.insert(getKey(input.file));
+
+        for (const auto& input : options.inputs)
+        {
+            auto file = std::make_shared<FileJob>();
+            file->input = input.file;
+            file->output = getOutputFileFor(input, options);
+
+            const char* error = nullptr;
+
+            if (! seenInputs.insert(getKey(input.file)).second)
+                error = "given more than once";
+            else if (inputPaths.count(getKey(file->output)) != 0)
+                error = "the output would overwrite an input, use --out-dir or --suffix";
+            else if (! outputPaths.insert(getKey(file->output)).second)
+                error = "another input renders to the same output, give their folders with --out-dir instead";
+            else if (! file->output.getParentDirectory().createDirectory())
+                error = "can't create the output's directory";
+
+            std::unique_ptr<juce::AudioFormatReader> reader (error == nullptr ? formats.createReaderFor(input.file) : nullptr);
+            if (error == nullptr && reader == nullptr)
+                error = "can't read it as audio";
+
+            if (error != nullptr)
+            {
+                ++failures;
+                std::fprintf(stderr, "%s: %s\n", input.file.getFullPathName().toRawUTF8(), error);
+                continue;
+            }
+
+            file->numChannels = (int)reader->numChannels;
+            file->lengthInSamples = reader->lengthInSamples;
+            file->sampleRate = reader->sampleRate;
+
+            const bool tooLong = options.splitSeconds > 0.0 && file->getAudioSeconds() > options.splitSeconds;
+            const bool split = file->numChannels > 2 || (file->numChannels > 1 && tooLong);
+
+            file->numParts = split ? file->numChannels : 1;
+            file->partsLeft = file->numParts;
+
+            if (split)
+                for (int ch = 0; ch < file->numChannels; ++ch)
+                    jobs.push_back({ file, ch, 1, true });
+            else
+                jobs.push_back({ file, 0, file->numChannels, false });
+        }
+
+        return jobs;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    Options options;
+    if (! parseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "usage: EQBatchRender [--threads N] [--split-seconds s] [--read-ahead samples] [--write-behind samples]"
+                             " [--state file] [--set \"ID=value\"]... [--out-dir dir] [--suffix text] [--chunk samples] input...\n");
+        return 2;
+    }
+
+    findInputs(options, formats.getWildcardForAllFormats());
+
+    // catch a bad state file or parameter name once, up front, rather than once per file
+    {
+        EQPluginAudioProcessor processor;
+        auto result = prepareForRender(processor, 2, 48000.0, options.render.chunkSize);
+        if (result.wasOk())
+            result = applySettings(processor, options.render);
+
+        if (result.failed())
+        {
+            std::fprintf(stderr, "%s\n", result.getErrorMessage().toRawUTF8());
+            return 1;
+        }
+    }
+
+    if (options.outputDirectory != juce::File() && ! options.outputDirectory.createDirectory())
+    {
+        std::fprintf(stderr, "can't create %s\n", options.outputDirectory.getFullPathName().toRawUTF8());
+        return 1;
+    }
+
+    // the write-behind buffer has to take a whole chunk, or write() would never have room
+    options.writeBehindSamples = juce::jmax(options.writeBehindSamples, 2 * options.render.chunkSize);
+
+    int failures = 0;
+    auto jobs = makeJobs(options, formats, failures);
+
+    double totalAudioSeconds = 0.0;
+    for (const auto& job : jobs)
+        if (job.firstChannel == 0)
+            totalAudioSeconds += job.file->getAudioSeconds();
+
+    const auto numJobs = (int)jobs.size();
+    options.numThreads = juce::jmin(options.numThreads, juce::jmax(1, numJobs));
+
+    Batch batch (options);
+    batch.failures = failures;
+    batch.queue.deal(std::move(jobs));
+
+    auto start = juce::Time::getHighResolutionTicks();
+    {
+        juce::OwnedArray<Worker> workers;
+        for (int i = 0; i < options.numThreads; ++i)
+            workers.add(new Worker(batch, i))->startThread();
+
+        for (auto* worker : workers)
+            worker->waitForThreadToExit(-1);
+    }
+    auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+    std::printf("\n%d files, %d jobs on %d threads, %d stolen\n", (int)options.inputs.size() - batch.failures.load(), numJobs,
+                options.numThreads, batch.queue.steals.load());
+    std::printf("%.1f s of audio in %.2f s, %.1fx realtime\n", totalAudioSeconds, seconds,
+                seconds > 0.0 ? totalAudioSeconds / seconds : 0.0);
+
+    return batch.failures.load() == 0 ? 0 : 1;
+}
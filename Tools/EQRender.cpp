@@ -0,0 +1,189 @@
+/*
+  ==============================================================================
+
+    EQRender.cpp
+    Renders audio files through the EQ from the command line, with the same
+    EQPluginAudioProcessor DSP the plugin builds use. The settings come from
+    a saved state, inline parameter values, or both. Files stream through in
+    fixed size chunks, so memory stays flat however long they are. Each
+    output keeps the input's format, rate, channel count and bit depth, and
+    has exactly as many samples, the EQ adds no latency.
+
+    usage: EQRender [options] input...
+
+      --state file        start from a state saved by the plugin, binary or XML
+      --set "ID=value"    set one parameter after the state, repeatable.
+                          e.g. --set "Peak Gain=6" --set "LowCut Slope=48 db/Oct"
+      --save-state file   write the resulting settings as XML, for --state later
+      --out-dir dir       where the outputs go, next to the inputs by default
+      --suffix text       added to each output's name, "_eq" by default
+      --chunk samples     samples per processBlock call, 4096 by default
+
+    Prints each file's throughput in x realtime and exits with 1 if any
+    file failed.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "OfflineRender.h"
+
+#include <cstdio>
+
+namespace
+{
+    struct Options
+    {
+        RenderSettings render;
+        juce::File saveStateFile, outputDirectory;
+        juce::String suffix = "_eq";
+        juce::Array<juce::File> inputs;
+    };
+
+    bool parseOptions(int argc, char* argv[], Options& options)
+    {
+        const auto cwd = juce::File::getCurrentWorkingDirectory();
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const juce::String argument (argv[i]);
+
+            if (! argument.startsWith("--"))
+            {
+                options.inputs.add(cwd.getChildFile(argument));
+                continue;
+            }
+
+            if (i + 1 >= argc)
+                return false;
+
+            const juce::String value (argv[++i]);
+
+            if (argument == "--state")              options.render.stateFile = cwd.getChildFile(value);
+            else if (argument == "--save-state")    options.saveStateFile = cwd.getChildFile(value);
+            else if (argument == "--out-dir")       options.outputDirectory = cwd.getChildFile(value);
+            else if (argument == "--suffix")        options.suffix = value;
+            else if (argument == "--chunk")         options.render.chunkSize = juce::jlimit(1, 1 << 20, value.getIntValue());
+            else if (argument == "--set")
+            {
+                std::pair<juce::String, juce::String> parameterOverride;
+                if (! parseOverride(value, parameterOverride))
+                    return false;
+
+                options.render.overrides.push_back(parameterOverride);
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return ! options.inputs.isEmpty() || options.saveStateFile != juce::File();
+    }
+
+    juce::Result renderFile(const Options& options, juce::AudioFormatManager& formats, const juce::File& input, double& audioSeconds, double& realtime)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor(input));
+        if (reader == nullptr)
+            return juce::Result::fail("can't read it as audio");
+
+        const auto numChannels = (int)reader->numChannels;
+        const auto chunkSize = options.render.chunkSize;
+
+        // a processor per file, nothing carries over from the last one
+        EQPluginAudioProcessor processor;
+
+        auto result = prepareForRender(processor, numChannels, reader->sampleRate, chunkSize);
+        if (result.wasOk())
+            result = applySettings(processor, options.render);
+        if (result.failed())
+            return result;
+
+        processor.prepareToPlay(reader->sampleRate, chunkSize);
+
+        auto output = getOutputFile(input, options.outputDirectory, options.suffix);
+        if (output == input)
+            return juce::Result::fail("the output would overwrite the input, use --out-dir or --suffix");
+
+        auto writer = createWriterFor(formats, output, *reader, numChannels);
+        if (writer == nullptr)
+            return juce::Result::fail("can't write " + output.getFullPathName());
+
+        auto start = juce::Time::getHighResolutionTicks();
+        result = renderStream(processor, *reader, 0, numChannels, *writer, chunkSize);
+        writer = nullptr; // flushes and finishes the file, part of the time it took
+        auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+        audioSeconds = double(reader->lengthInSamples) / reader->sampleRate;
+        realtime = seconds > 0.0 ? audioSeconds / seconds : 0.0;
+        return result;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (! parseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "usage: EQRender [--state file] [--set \"ID=value\"]... [--save-state file] [--out-dir dir]"
+                             " [--suffix text] [--chunk samples] input...\n");
+        return 2;
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    if (options.saveStateFile != juce::File())
+    {
+        EQPluginAudioProcessor processor;
+        auto result = prepareForRender(processor, 2, 48000.0, options.render.chunkSize);
+        if (result.wasOk())
+            result = applySettings(processor, options.render);
+
+        if (result.failed() || ! options.saveStateFile.replaceWithText(processor.apvts.copyState().toXmlString()))
+        {
+            std::fprintf(stderr, "can't save the state: %s\n", result.failed() ? result.getErrorMessage().toRawUTF8() : "write failed");
+            return 1;
+        }
+    }
+
+    if (options.outputDirectory != juce::File() && ! options.outputDirectory.createDirectory())
+    {
+        std::fprintf(stderr, "can't create %s\n", options.outputDirectory.getFullPathName().toRawUTF8());
+        return 1;
+    }
+
+    int failures = 0;
+    double totalAudioSeconds = 0.0;
+    auto start = juce::Time::getHighResolutionTicks();
+
+    for (const auto& input : options.inputs)
+    {
+        double audioSeconds = 0.0, realtime = 0.0;
+        auto result = renderFile(options, formats, input, audioSeconds, realtime);
+
+        if (result.failed())
+        {
+            std::fprintf(stderr, "%s: %s\n", input.getFileName().toRawUTF8(), result.getErrorMessage().toRawUTF8());
+            ++failures;
+            continue;
+        }
+
+        totalAudioSeconds += audioSeconds;
+        std::printf("%s -> %s  %.1fx realtime\n", input.getFileName().toRawUTF8(),
+                    getOutputFile(input, options.outputDirectory, options.suffix).getFileName().toRawUTF8(), realtime);
+        std::fflush(stdout);
+    }
+
+    if (options.inputs.size() > 1)
+    {
+        auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        std::printf("%d files, %.1f s of audio, %.1fx realtime overall\n", options.inputs.size() - failures,
+                    totalAudioSeconds, seconds > 0.0 ? totalAudioSeconds / seconds : 0.0);
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+/*
+  ==============================================================================
+
+    OfflineRender.h
+    Runs audio files through EQPluginAudioProcessor outside of any host.
+    It loads a saved state and parameter overrides into a processor, then
+    streams a reader through processBlock into a writer in fixed size
+    chunks, so memory use doesn't depend on how long the file is. The
+    command line renderers in this directory are built on it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+struct RenderSettings
+{
+    juce::File stateFile;   // as written by getStateInformation, or the state tree as XML
+    std::vector<std::pair<juce::String, juce::String>> overrides;  // parameter ID, value, applied after the state
+    int chunkSize = 4096;
+};
+
+// "Peak Gain=6" -> { "Peak Gain", "6" }. false if there's no '='
+inline bool parseOverride(const juce::String& text, std::pair<juce::String, juce::String>& result)
+{
+    if (! text.containsChar('='))
+        return false;
+
+    result = { text.upToFirstOccurrenceOf("=", false, false).trim(), text.fromFirstOccurrenceOf("=", false, false).trim() };
+    return result.first.isNotEmpty() && result.second.isNotEmpty();
+}
+
+// loads the state file, if there is one, then the overrides. numbers are in the parameter's own units
+// (Hz, dB, the index of a slope), anything else goes through the parameter's text parsing, so "48 db/Oct" or "true" work too
+inline juce::Result applySettings(EQPluginAudioProcessor& processor, const RenderSettings& settings)
+{
+    if (settings.stateFile != juce::File())
+    {
+        juce::MemoryBlock data;
+        if (! settings.stateFile.loadFileAsData(data))
+            return juce::Result::fail("can't read " + settings.stateFile.getFullPathName());
+
+        if (auto xml = juce::parseXML(data.toString()))
+        {
+            auto tree = juce::ValueTree::fromXml(*xml);
+            if (! tree.hasType(processor.apvts.state.getType()))
+                return juce::Result::fail(settings.stateFile.getFileName() + " isn't a state for this plugin");
+
+            processor.apvts.replaceState(tree);
+        }
+        else
+        {
+            if (! juce::ValueTree::readFromData(data.getData(), data.getSize()).isValid())
+                return juce::Result::fail(settings.stateFile.getFileName() + " isn't a saved plugin state");
+
+            processor.setStateInformation(data.getData(), (int)data.getSize());
+        }
+    }
+
+    for (const auto& [parameterID, text] : settings.overrides)
+    {
+        auto* parameter = processor.apvts.getParameter(parameterID);
+        if (parameter == nullptr)
+            return juce::Result::fail("no parameter called '" + parameterID + "'");
+
+        const bool isNumber = text.containsOnly("0123456789.-+eE");
+        parameter->setValueNotifyingHost(isNumber ? parameter->convertTo0to1(text.getFloatValue())
+                                                  : parameter->getValueForText(text));
+    }
+
+    return juce::Result::ok();
+}
+
+// mono or stereo, sized and rated for 'reader' and ready to render. call applySettings after this, the state
+// designs the filters for the sample rate it finds
+inline juce::Result prepareForRender(EQPluginAudioProcessor& processor, int numChannels, double sampleRate, int chunkSize)
+{
+    const auto channelSet = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(channelSet);
+    layout.outputBuses.add(channelSet);
+
+    if (numChannels < 1 || numChannels > 2 || ! processor.setBusesLayout(layout))
+        return juce::Result::fail(juce::String(numChannels) + " channels, only mono and stereo are supported");
+
+    processor.setNonRealtime(true);
+    processor.setRateAndBufferSizeDetails(sampleRate, chunkSize);
+    return juce::Result::ok();
+}
+
+// a writer with the same rate, channel count and bit depth as the source where the format allows it,
+// the nearest bit depth it has otherwise
+inline std::unique_ptr<juce::AudioFormatWriter> createWriterFor(juce::AudioFormatManager& formats, const juce::File& output,
+                                                                const juce::AudioFormatReader& source, int numChannels)
+{
+    auto* format = formats.findFormatForFileExtension(output.getFileExtension());
+    if (format == nullptr)
+        return nullptr;
+
+    auto bitDepth = (int)source.bitsPerSample;
+    const auto depths = format->getPossibleBitDepths();
+    if (! depths.isEmpty() && ! depths.contains(bitDepth))
+    {
+        auto nearest = depths.getFirst();
+        for (auto depth : depths)
+            if (std::abs(depth - bitDepth) < std::abs(nearest - bitDepth))
+                nearest = depth;
+        bitDepth = nearest;
+    }
+
+    output.deleteFile();
+    std::unique_ptr<juce::OutputStream> stream (output.createOutputStream());
+    if (stream == nullptr)
+        return nullptr;
+
+    std::unique_ptr<juce::AudioFormatWriter> writer (format->createWriterFor(stream.get(), source.sampleRate, (unsigned int)numChannels,
+                                                                             bitDepth, source.metadataValues, 0));
+    if (writer != nullptr)
+        stream.release(); // the writer owns it now
+
+    return writer;
+}
+
+// where 'input' renders to: 'outputDirectory' if there is one, next to the input otherwise, with 'suffix' on the name
+inline juce::File getOutputFile(const juce::File& input, const juce::File& outputDirectory, const juce::String& suffix)
+{
+    auto directory = outputDirectory != juce::File() ? outputDirectory : input.getParentDirectory();
+    return directory.getChildFile(input.getFileNameWithoutExtension() + suffix + input.getFileExtension());
+}
+
+// streams 'numChannels' channels of 'reader', starting at 'firstChannel', through the processor, 'chunkSize' samples
+// at a time, and hands every processed chunk to 'writeChunk'. the processor has to be prepared for that many channels
+// and that chunk size
+inline juce::Result renderStream(EQPluginAudioProcessor& processor, juce::AudioFormatReader& reader, int firstChannel, int numChannels,
+                                 int chunkSize, const std::function<bool(const juce::AudioBuffer<float>&)>& writeChunk)
+{
+    juce::AudioBuffer<float> source ((int)reader.numChannels, chunkSize);
+    juce::AudioBuffer<float> chunk (numChannels, chunkSize);
+    juce::MidiBuffer midi;
+
+    for (juce::int64 position = 0; position < reader.lengthInSamples; position += chunkSize)
+    {
+        const auto numSamples = (int)juce::jmin((juce::int64)chunkSize, reader.lengthInSamples - position);
+
+        if (! reader.read(&source, 0, numSamples, position, true, true))
+            return juce::Result::fail("read failed at sample " + juce::String(position));
+
+        // the last chunk is usually short, hand processBlock exactly what's left
+        chunk.setSize(numChannels, numSamples, false, false, true);
+        for (int ch = 0; ch < numChannels; ++ch)
+            chunk.copyFrom(ch, 0, source, firstChannel + ch, 0, numSamples);
+
+        processor.processBlock(chunk, midi);
+
+        if (! writeChunk(chunk))
+            return juce::Result::fail("write failed at sample " + juce::String(position));
+    }
+
+    return juce::Result::ok();
+}
+
+inline juce::Result renderStream(EQPluginAudioProcessor& processor, juce::AudioFormatReader& reader, int firstChannel, int numChannels,
+                                 juce::AudioFormatWriter& writer, int chunkSize)
+{
+    return renderStream(processor, reader, firstChannel, numChannels, chunkSize, [&writer](const juce::AudioBuffer<float>& chunk)
+    {
+        return writer.writeFromAudioSampleBuffer(chunk, 0, chunk.getNumSamples());
+    });
+}
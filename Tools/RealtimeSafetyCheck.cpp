@@ -0,0 +1,306 @@
+/*
+  ==============================================================================
+
+    RealtimeSafetyCheck.cpp
+    Runs EQPluginAudioProcessor::processBlock under random automation of
+    every parameter, slopes and bypasses included, at several sample rates
+    and block sizes. Along the way this file interposes malloc, free,
+    operator new/delete and pthread_mutex_lock, and records each call made
+    inside an EQ_REALTIME_SECTION with a backtrace. It prints every distinct
+    call site at the end and exits with 1 if there were any.
+
+    Set EQ_RT_TRAP=1 to raise SIGTRAP at the first violation instead, to
+    stop right there in a debugger.
+
+    usage: RealtimeSafetyCheck [blocks per configuration]
+
+    Linux (glibc) only, it needs the __libc_ allocator entry points.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+
+#if JUCE_LINUX
+
+#include <cerrno>
+#include <cstring>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+    void __libc_free(void*);
+}
+
+namespace
+{
+    enum class Violation { malloc, calloc, realloc, free, alignedAlloc, operatorNew, operatorDelete, mutexLock };
+
+    const char* describe(Violation kind)
+    {
+        switch (kind)
+        {
+            case Violation::malloc:         return "malloc";
+            case Violation::calloc:         return "calloc";
+            case Violation::realloc:        return "realloc";
+            case Violation::free:           return "free";
+            case Violation::alignedAlloc:   return "aligned alloc";
+            case Violation::operatorNew:    return "operator new";
+            case Violation::operatorDelete: return "operator delete";
+            case Violation::mutexLock:      return "pthread_mutex_lock";
+        }
+
+        return "";
+    }
+
+    // fixed storage, recording a violation mustn't allocate
+    struct Record
+    {
+        Violation kind;
+        size_t bytes;
+        void* frames[24];
+        int numFrames;
+    };
+
+    constexpr int maxRecords = 512;
+    Record records[maxRecords];
+    std::atomic<int> numViolations { 0 };
+    bool trapOnViolation = false;
+
+    // backtrace() can allocate, which would land right back in here
+    thread_local bool reporting = false;
+
+    // never inlined, so it's always exactly the first frame of the backtrace
+    [[gnu::noinline]] void check(Violation kind, size_t bytes)
+    {
+        if (reporting || ! RealtimeSection::isActive())
+            return;
+
+        reporting = true;
+
+        auto index = numViolations.fetch_add(1);
+        if (index < maxRecords)
+        {
+            auto& record = records[index];
+            record.kind = kind;
+            record.bytes = bytes;
+            record.numFrames = backtrace(record.frames, (int)std::size(record.frames));
+        }
+
+        reporting = false;
+
+        if (trapOnViolation)
+            raise(SIGTRAP);
+    }
+
+    using MutexLockFunction = int (*)(pthread_mutex_t*);
+    std::atomic<MutexLockFunction> realMutexLock { nullptr };
+
+    bool sameCallSite(const Record& a, const Record& b)
+    {
+        return a.kind == b.kind && a.numFrames == b.numFrames
+            && std::memcmp(a.frames, b.frames, sizeof(void*) * (size_t)a.numFrames) == 0;
+    }
+
+    int printReport()
+    {
+        const auto total = numViolations.load();
+        const auto recorded = juce::jmin(total, maxRecords);
+
+        if (total == 0)
+        {
+            std::printf("no allocations or locks inside processBlock\n");
+            return 0;
+        }
+
+        std::printf("%d allocations or locks inside processBlock, distinct call sites:\n", total);
+
+        for (int i = 0; i < recorded; ++i)
+        {
+            bool seenBefore = false;
+            int count = 0;
+
+            for (int j = 0; j < recorded; ++j)
+            {
+                if (sameCallSite(records[i], records[j]))
+                {
+                    seenBefore = seenBefore || j < i;
+                    ++count;
+                }
+            }
+
+            if (seenBefore)
+                continue;
+
+            std::printf("\n%s (%zu bytes), %d times\n", describe(records[i].kind), records[i].bytes, count);
+            std::fflush(stdout);
+
+            // leave out check() itself, the interposed function it came from stays as the first frame
+            const int skip = juce::jmin(1, records[i].numFrames);
+            backtrace_symbols_fd(records[i].frames + skip, records[i].numFrames - skip, STDOUT_FILENO);
+        }
+
+        return 1;
+    }
+}
+
+//==============================================================================
+extern "C"
+{
+    void* malloc(size_t size)                   { check(Violation::malloc, size); return __libc_malloc(size); }
+    void* calloc(size_t count, size_t size)     { check(Violation::calloc, count * size); return __libc_calloc(count, size); }
+    void* realloc(void* pointer, size_t size)   { check(Violation::realloc, size); return __libc_realloc(pointer, size); }
+    void* memalign(size_t alignment, size_t size)       { check(Violation::alignedAlloc, size); return __libc_memalign(alignment, size); }
+    void* aligned_alloc(size_t alignment, size_t size)  { check(Violation::alignedAlloc, size); return __libc_memalign(alignment, size); }
+
+    void free(void* pointer)
+    {
+        if (pointer != nullptr)
+            check(Violation::free, 0);
+
+        __libc_free(pointer);
+    }
+
+    int posix_memalign(void** result, size_t alignment, size_t size)
+    {
+        check(Violation::alignedAlloc, size);
+        *result = __libc_memalign(alignment, size);
+        return *result != nullptr ? 0 : ENOMEM;
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t* mutex)
+    {
+        check(Violation::mutexLock, 0);
+
+        // looked up without a function static, its guard could take this very lock
+        auto lock = realMutexLock.load();
+        if (lock == nullptr)
+        {
+            lock = reinterpret_cast<MutexLockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+            realMutexLock.store(lock);
+        }
+
+        return lock(mutex);
+    }
+}
+
+static void* allocate(size_t size, Violation kind)
+{
+    check(kind, size);
+
+    if (auto* pointer = __libc_malloc(size == 0 ? 1 : size))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+static void* allocateAligned(size_t size, std::align_val_t alignment)
+{
+    check(Violation::operatorNew, size);
+
+    if (auto* pointer = __libc_memalign(static_cast<size_t>(alignment), size == 0 ? 1 : size))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+static void deallocate(void* pointer) noexcept
+{
+    if (pointer != nullptr)
+        check(Violation::operatorDelete, 0);
+
+    __libc_free(pointer);
+}
+
+void* operator new(size_t size)                                 { return allocate(size, Violation::operatorNew); }
+void* operator new[](size_t size)                               { return allocate(size, Violation::operatorNew); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept   { try { return allocate(size, Violation::operatorNew); } catch (...) { return nullptr; } }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { try { return allocate(size, Violation::operatorNew); } catch (...) { return nullptr; } }
+void* operator new(size_t size, std::align_val_t alignment)     { return allocateAligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment)   { return allocateAligned(size, alignment); }
+
+void operator delete(void* pointer) noexcept                                { deallocate(pointer); }
+void operator delete[](void* pointer) noexcept                              { deallocate(pointer); }
+void operator delete(void* pointer, size_t) noexcept                        { deallocate(pointer); }
+void operator delete[](void* pointer, size_t) noexcept                      { deallocate(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept         { deallocate(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept       { deallocate(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept              { deallocate(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept            { deallocate(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept      { deallocate(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept    { deallocate(pointer); }
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    // the first backtrace() loads the unwinder, get that out of the way before anything is marked
+    void* warmUp[4];
+    backtrace(warmUp, 4);
+
+    trapOnViolation = std::getenv("EQ_RT_TRAP") != nullptr;
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const int blocksPerConfiguration = argc > 1 ? juce::jmax(1, std::atoi(argv[1])) : 20000;
+
+    for (auto sampleRate : { 44100.0, 96000.0 })
+    {
+        for (auto blockSize : { 1, 16, 64, 512, 2048 })
+        {
+            EQPluginAudioProcessor processor;
+            processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            juce::AudioBuffer<float> buffer (2, blockSize);
+            juce::MidiBuffer midi;
+            juce::Random random (blockSize);
+
+            const auto& parameters = processor.getParameters();
+            const auto violationsBefore = numViolations.load();
+
+            for (int i = 0; i < blocksPerConfiguration; ++i)
+            {
+                // automation arrives between blocks like it would from a host, every parameter is fair game,
+                // so slopes change and stages get bypassed and brought back all the time
+                auto* parameter = parameters[random.nextInt(parameters.size())];
+                parameter->setValueNotifyingHost(random.nextFloat());
+
+                for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                    for (int n = 0; n < blockSize; ++n)
+                        buffer.setSample(ch, n, random.nextFloat() * 0.5f - 0.25f);
+
+                processor.processBlock(buffer, midi);
+            }
+
+            std::printf("%6.0f Hz, %4d samples: %d violations\n", sampleRate, blockSize, numViolations.load() - violationsBefore);
+        }
+    }
+
+    std::printf("\n");
+    return printReport();
+}
+
+#else
+
+int main()
+{
+    std::printf("RealtimeSafetyCheck only runs on Linux with glibc\n");
+    return 0;
+}
+
+#endif